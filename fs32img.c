@@ -0,0 +1,456 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include <err.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "FS32_internals.h"
+
+/*
+This tool builds a FAT32 image for kittenFS32 (1 sector per cluster, a single FAT, FSInfo) from a list of files. Every file is stored contiguously in the given order, the directory entries are in the same order. The image can be written to the SD-card using dd.
+
+(c) 2022 by kittennbfive
+
+AGPLv3+ and NO WARRANTY!
+
+Please read the documentation!
+
+compile: gcc -Wall -Wextra -Werror -I with_file_system -o fs32img fs32img.c
+*/
+
+#define NB_RESERVED_SECTORS 32
+#define SECTOR_BACKUP_BOOT 6
+#define NB_CLUSTERS_MIN 65525 //below this it is FAT16 for everybody else
+#define MBR_START_OF_PARTITION 2048
+#define FAT_DATE ((2022-1980)<<9|1<<5|1) //fixed date/time so the same input gives the same image
+#define FAT_TIME 0
+
+typedef struct
+{
+	char path[256];
+	char name[256]; //name on the card
+	uint32_t size;
+	uint32_t first_cluster;
+	uint32_t last_cluster; //end of the chain
+	uint8_t nb_lfn_entries; //0 if the name is valid 8.3
+	char short_name[11];
+} input_file_t;
+
+static void print_usage_and_exit(void)
+{
+	printf("usage: fs32img [--size $MB] [--mbr] image.img file1[=NAME1] [file2[=NAME2] ...]\n\nFiles are stored contiguously in the given order (use the order in which they will be played).\nNAME is the name on the card, default is the name of the input file without path. Names that are valid 8.3 are stored in uppercase, all other names get a long name.\n$MB is the size of the image, default is just big enough (at least about 33MB, FAT32 needs 65525 clusters).\n--mbr adds a partition table, the partition starts at sector %u (use f_set_partition(0) in the firmware).\nWarning: An existing image will be overwritten!\n\n", MBR_START_OF_PARTITION);
+	exit(0);
+}
+
+static bool is_valid_short_char(const char c)
+{
+	return (c>='A' && c<='Z') || (c>='0' && c<='9') || strchr("!#$%&'()-@^_`{}~", c);
+}
+
+//returns true if name is a valid 8.3 name (lowercase is stored as uppercase), fills short_name
+static bool make_short_name(char const * const name, char * const short_name)
+{
+	memset(short_name, ' ', 11);
+
+	char const * dot=strrchr(name, '.');
+	size_t len_base=dot?(size_t)(dot-name):strlen(name);
+	size_t len_ext=dot?strlen(dot+1):0;
+
+	if(len_base==0 || len_base>8 || len_ext>3 || (dot && len_ext==0))
+		return false;
+
+	size_t i;
+	for(i=0; i<len_base; i++)
+	{
+		char c=toupper((unsigned char)name[i]);
+		if(!is_valid_short_char(c))
+			return false;
+		short_name[i]=c;
+	}
+	for(i=0; i<len_ext; i++)
+	{
+		char c=toupper((unsigned char)dot[1+i]);
+		if(!is_valid_short_char(c))
+			return false;
+		short_name[8+i]=c;
+	}
+
+	return true;
+}
+
+//short alias NAME~N.EXT for a long name
+static void make_short_alias(char const * const name, const uint16_t nb, char * const short_name)
+{
+	memset(short_name, ' ', 11);
+
+	char tail[8];
+	uint8_t len_tail=sprintf(tail, "~%u", nb);
+
+	char const * dot=strrchr(name, '.');
+	char const * p;
+	uint8_t i=0;
+	for(p=name; *p && p!=dot && i<8-len_tail; p++)
+	{
+		char c=toupper((unsigned char)*p);
+		if(is_valid_short_char(c))
+			short_name[i++]=c;
+	}
+	if(i==0)
+		short_name[i++]='_';
+	memcpy(&short_name[i], tail, len_tail);
+
+	if(dot)
+	{
+		i=0;
+		for(p=dot+1; *p && i<3; p++)
+		{
+			char c=toupper((unsigned char)*p);
+			if(is_valid_short_char(c))
+				short_name[8+i++]=c;
+		}
+	}
+}
+
+static uint8_t short_name_checksum(char const * const short_name)
+{
+	uint8_t sum=0;
+	uint8_t i;
+	for(i=0; i<11; i++)
+		sum=((sum&1)<<7)+(sum>>1)+(uint8_t)short_name[i];
+	return sum;
+}
+
+static void write_sector(FILE * const img, const uint64_t sector, void const * const data)
+{
+	if(fseeko(img, sector*512, SEEK_SET))
+		err(1, "seeking in image failed");
+	if(fwrite(data, 1, 512, img)!=512)
+		err(1, "writing image failed");
+}
+
+int main(int argc, char **argv)
+{
+	const struct option optiontable[]=
+	{
+		{ "size",		required_argument,	NULL,	0 },
+		{ "mbr",		no_argument,		NULL,	1 },
+		{ "help",		no_argument,		NULL, 	101 },
+		{ "usage",		no_argument,		NULL, 	101 },
+		{ NULL, 0, NULL, 0 }
+	};
+
+	int optionindex;
+	int opt;
+
+	uint64_t size_requested=0;
+	bool with_mbr=false;
+
+	printf("\nThis is fs32img (c) 2022 by kittennbfive\nThis tool is released under AGPLv3+ and comes WITHOUT ANY WARRANTY!\n\n");
+
+	if(argc==1)
+		print_usage_and_exit();
+
+	while((opt=getopt_long(argc, argv, "", optiontable, &optionindex))!=-1)
+	{
+		switch(opt)
+		{
+			case '?': print_usage_and_exit(); break;
+			case 0: size_requested=(uint64_t)atol(optarg)*1024*1024; break;
+			case 1: with_mbr=true; break;
+			case 101: print_usage_and_exit(); break;
+
+			default: errx(1, "don't know how to handle %d returned by getopt_long", opt); break;
+		}
+	}
+
+	if(argc-optind<2)
+		errx(1, "missing image and/or input file names");
+
+	char const * const image_name=argv[optind];
+	uint32_t nb_files=argc-optind-1;
+
+	input_file_t * files=calloc(nb_files, sizeof(input_file_t));
+	if(!files)
+		err(1, "malloc failed");
+
+	//names and sizes
+	uint32_t nb_dir_entries=0;
+	uint32_t nb_data_clusters=0;
+	uint32_t i, j;
+	for(i=0; i<nb_files; i++)
+	{
+		char const * arg=argv[optind+1+i];
+		char const * eq=strchr(arg, '=');
+		size_t len_path=eq?(size_t)(eq-arg):strlen(arg);
+		if(len_path>=sizeof(files[i].path))
+			errx(1, "path too long: %s", arg);
+		memcpy(files[i].path, arg, len_path);
+
+		char const * name=eq?eq+1:files[i].path;
+		if(!eq && strrchr(name, '/'))
+			name=strrchr(name, '/')+1;
+		if(strlen(name)==0 || strlen(name)>=sizeof(files[i].name) || strlen(name)>13*LFN_ORD_MASK)
+			errx(1, "invalid name for %s", files[i].path);
+		strcpy(files[i].name, name);
+
+		struct stat st;
+		if(stat(files[i].path, &st))
+			err(1, "can't access %s", files[i].path);
+		if(st.st_size>0xFFFFFFFFLL)
+			errx(1, "%s is too big for FAT32", files[i].path);
+		files[i].size=st.st_size;
+
+		for(j=0; j<i; j++)
+		{
+			if(!strcasecmp(files[i].name, files[j].name))
+				errx(1, "name %s used twice", files[i].name);
+		}
+
+		if(make_short_name(files[i].name, files[i].short_name))
+		{
+			char * p;
+			for(p=files[i].name; *p; p++)
+				*p=toupper((unsigned char)*p); //this is the name for f_open()
+		}
+		else
+		{
+			files[i].nb_lfn_entries=(strlen(files[i].name)+12)/13;
+			make_short_alias(files[i].name, i+1, files[i].short_name);
+		}
+
+		nb_dir_entries+=1+files[i].nb_lfn_entries;
+		nb_data_clusters+=(files[i].size+511)/512;
+	}
+
+	nb_dir_entries++; //end marker
+	uint32_t nb_root_clusters=(nb_dir_entries*sizeof(fat32_directory_entry_t)+511)/512;
+
+	//geometry: FAT has 128 entries per sector, entries 0 and 1 are reserved
+	uint32_t nb_clusters_min=nb_root_clusters+nb_data_clusters;
+	if(nb_clusters_min<NB_CLUSTERS_MIN)
+		nb_clusters_min=NB_CLUSTERS_MIN;
+
+	uint32_t start_of_partition=with_mbr?MBR_START_OF_PARTITION:0;
+	uint64_t nb_sectors_total;
+	if(size_requested)
+		nb_sectors_total=size_requested/512-start_of_partition;
+	else
+		nb_sectors_total=NB_RESERVED_SECTORS+(nb_clusters_min+2+127)/128+nb_clusters_min;
+
+	if(nb_sectors_total>0xFFFFFFFF)
+		errx(1, "image too big");
+
+	uint32_t fat_size=1;
+	while(NB_RESERVED_SECTORS+fat_size+(uint64_t)fat_size*128-2<nb_sectors_total)
+		fat_size++;
+	uint32_t nb_clusters=nb_sectors_total-NB_RESERVED_SECTORS-fat_size;
+	if(nb_clusters>(uint64_t)fat_size*128-2)
+		nb_clusters=fat_size*128-2;
+
+	if(nb_clusters<nb_clusters_min)
+		errx(1, "image too small, need at least %luMB", (unsigned long)(((uint64_t)NB_RESERVED_SECTORS+(nb_clusters_min+2+127)/128+nb_clusters_min+start_of_partition)*512/1024/1024+1));
+
+	uint32_t first_data_sector=NB_RESERVED_SECTORS+fat_size;
+
+	FILE * img=fopen(image_name, "wb+");
+	if(!img)
+		err(1, "creating image %s failed", image_name);
+
+	if(ftruncate(fileno(img), (start_of_partition+nb_sectors_total)*512))
+		err(1, "setting size of image failed");
+
+	uint8_t sector[512];
+
+	//MBR
+	if(with_mbr)
+	{
+		memset(sector, 0, 512);
+		master_boot_record_t * mbr=(master_boot_record_t*)sector;
+		mbr->Partitions[0].PartitionType=0x0C; //FAT32 LBA
+		mbr->Partitions[0].StartSectorLBA=start_of_partition;
+		mbr->Partitions[0].NumberOfSectors=nb_sectors_total;
+		mbr->BootSignature=0xAA55;
+		write_sector(img, 0, sector);
+	}
+
+	//boot sector
+	uint32_t volume_id=2166136261U; //FNV-1a over names and sizes, same input gives same image
+	for(i=0; i<nb_files; i++)
+	{
+		char const * p;
+		for(p=files[i].name; *p; p++)
+			volume_id=(volume_id^(uint8_t)*p)*16777619U;
+		volume_id=(volume_id^files[i].size)*16777619U;
+	}
+
+	memset(sector, 0, 512);
+	fat32_header_t * header=(fat32_header_t*)sector;
+	header->BS_jmpBoot[0]=0xEB;
+	header->BS_jmpBoot[1]=0x58;
+	header->BS_jmpBoot[2]=0x90;
+	memcpy(header->BS_OEMName, "FS32IMG ", 8);
+	header->BPB_BytsPerSec=512;
+	header->BPB_SecPerClus=1;
+	header->BPB_RsvdSecCnt=NB_RESERVED_SECTORS;
+	header->BPB_NumFATs=1;
+	header->BPB_Media=0xF8;
+	header->BPB_SecPerTrk=32;
+	header->BPB_NumHeads=64;
+	header->BPB_HiddSec=start_of_partition;
+	header->BPB_TotSec32=nb_sectors_total;
+	header->BPB_FATSz32=fat_size;
+	header->BPB_RootClus=2;
+	header->BPB_FSInfo=1;
+	header->BPB_BkBootSec=SECTOR_BACKUP_BOOT;
+	header->BS_DrvNum=0x80;
+	header->BS_BootSig=0x29;
+	header->BS_VolID=volume_id;
+	memcpy(header->BS_VolLab, "PDM AUDIO  ", 11);
+	memcpy(header->BS_FilSysType, "FAT32   ", 8);
+	sector[510]=0x55;
+	sector[511]=0xAA;
+	write_sector(img, start_of_partition, sector);
+	write_sector(img, start_of_partition+SECTOR_BACKUP_BOOT, sector);
+
+	//allocation: root directory first, then the files in the given order
+	uint32_t next_cluster=2+nb_root_clusters;
+	for(i=0; i<nb_files; i++)
+	{
+		if(files[i].size)
+		{
+			files[i].first_cluster=next_cluster;
+			next_cluster+=(files[i].size+511)/512;
+			files[i].last_cluster=next_cluster-1;
+		}
+	}
+	uint32_t last_allocated=next_cluster-1;
+
+	//FSInfo
+	memset(sector, 0, 512);
+	fat32_fsinfo_t * fsinfo=(fat32_fsinfo_t*)sector;
+	fsinfo->FSI_LeadSig=FSI_LEADSIG;
+	fsinfo->FSI_StrucSig=FSI_STRUCSIG;
+	fsinfo->FSI_Free_Count=nb_clusters-(next_cluster-2);
+	fsinfo->FSI_Last_Allocated=last_allocated;
+	fsinfo->FSI_TrailSig=FSI_TRAILSIG;
+	write_sector(img, start_of_partition+1, sector);
+	write_sector(img, start_of_partition+SECTOR_BACKUP_BOOT+1, sector);
+
+	//FAT, only the used sectors need to be written, the rest is 0 (free) already
+	//the files are allocated in order, so the next end of a chain is always the one of the file next_end
+	fat32_entry_t * fat=(fat32_entry_t*)sector;
+	uint32_t next_end=0;
+	while(next_end<nb_files && !files[next_end].size)
+		next_end++;
+	uint32_t fat_sector;
+	for(fat_sector=0; fat_sector<=last_allocated/128; fat_sector++)
+	{
+		uint8_t e;
+		for(e=0; e<128; e++)
+		{
+			uint32_t cluster=fat_sector*128+e;
+			if(cluster==0)
+				fat[e]=0x0FFFFF00|header->BPB_Media;
+			else if(cluster==1)
+				fat[e]=0x0FFFFFFF;
+			else if(cluster>last_allocated)
+				fat[e]=0;
+			else if(cluster==1+nb_root_clusters)
+				fat[e]=0x0FFFFFFF; //end of root directory
+			else if(cluster<2+nb_root_clusters)
+				fat[e]=cluster+1;
+			else if(next_end<nb_files && cluster==files[next_end].last_cluster)
+			{
+				fat[e]=0x0FFFFFFF;
+				do
+					next_end++;
+				while(next_end<nb_files && !files[next_end].size);
+			}
+			else
+				fat[e]=cluster+1;
+		}
+		write_sector(img, start_of_partition+NB_RESERVED_SECTORS+fat_sector, sector);
+	}
+
+	//root directory
+	uint8_t * dir=calloc(nb_root_clusters, 512);
+	if(!dir)
+		err(1, "malloc failed");
+	fat32_directory_entry_t * entry=(fat32_directory_entry_t*)dir;
+	for(i=0; i<nb_files; i++)
+	{
+		uint8_t checksum=short_name_checksum(files[i].short_name);
+		uint8_t ord;
+		for(ord=files[i].nb_lfn_entries; ord>0; ord--)
+		{
+			//13 UCS-2 characters per entry, the last entry comes first
+			fat32_lfn_entry_t * lfn=(fat32_lfn_entry_t*)entry;
+			uint16_t chars[13];
+			uint8_t c;
+			for(c=0; c<13; c++)
+			{
+				size_t pos=(ord-1)*13+c;
+				size_t len=strlen(files[i].name);
+				if(pos<len)
+					chars[c]=(uint8_t)files[i].name[pos];
+				else if(pos==len)
+					chars[c]=0x0000;
+				else
+					chars[c]=0xFFFF;
+			}
+			lfn->LDIR_Ord=ord|((ord==files[i].nb_lfn_entries)?LFN_LAST_LONG_ENTRY:0);
+			memcpy(lfn->LDIR_Name1, &chars[0], 10);
+			lfn->LDIR_Attr=ATTR_LONG_NAME;
+			lfn->LDIR_Chksum=checksum;
+			memcpy(lfn->LDIR_Name2, &chars[5], 12);
+			memcpy(lfn->LDIR_Name3, &chars[11], 4);
+			entry++;
+		}
+
+		memcpy(entry->DIR_Name, files[i].short_name, 8);
+		memcpy(entry->DIR_Ext, files[i].short_name+8, 3);
+		entry->DIR_Attr=ATTR_ARCHIVE;
+		entry->DIR_WrtDate=FAT_DATE;
+		entry->DIR_WrtTime=FAT_TIME;
+		entry->DIR_FstClusHI=files[i].first_cluster>>16;
+		entry->DIR_FstClusLO=files[i].first_cluster&0xFFFF;
+		entry->DIR_FileSize=files[i].size;
+		entry++;
+	}
+	for(i=0; i<nb_root_clusters; i++)
+		write_sector(img, start_of_partition+first_data_sector+i, &dir[i*512]);
+	free(dir);
+
+	//data
+	for(i=0; i<nb_files; i++)
+	{
+		FILE * inp=fopen(files[i].path, "rb");
+		if(!inp)
+			err(1, "opening %s failed", files[i].path);
+		uint32_t s;
+		for(s=0; s<(files[i].size+511)/512; s++)
+		{
+			memset(sector, 0, 512);
+			if(fread(sector, 1, 512, inp)==0)
+				errx(1, "reading %s failed", files[i].path);
+			write_sector(img, start_of_partition+first_data_sector+files[i].first_cluster-2+s, sector);
+		}
+		fclose(inp);
+		if(files[i].size)
+			printf("%-12.11s %s: %u bytes, sectors %u-%u\n", files[i].short_name, files[i].name, files[i].size, start_of_partition+first_data_sector+files[i].first_cluster-2, start_of_partition+first_data_sector+files[i].first_cluster-2+(files[i].size+511)/512-1);
+		else
+			printf("%-12.11s %s: empty\n", files[i].short_name, files[i].name);
+	}
+
+	fclose(img);
+	free(files);
+
+	printf("\n%s: %luMB, %u clusters, %u free. Write it to the card with dd.\n\n", image_name, (unsigned long)((start_of_partition+nb_sectors_total)*512/1024/1024), nb_clusters, nb_clusters-(next_cluster-2));
+
+	return 0;
+}
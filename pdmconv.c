@@ -1,10 +1,33 @@
+#define _GNU_SOURCE //O_DIRECT
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
+#include <strings.h>
 #include <err.h>
 #include <getopt.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#include <limits.h>
+#include <pthread.h>
+
+#define PDM_CODEC_ENCODER 1
+#define PDM_CODEC_DECODER 1
+#include "pdm_codec.h"
+
+#include "pdm_header.h"
+
+#include "pdmenc.h"
 
 /*
 This tool converts a wave file into a PDM-data-file to be played through an ATmega328P.
@@ -15,7 +38,7 @@ AGPLv3+ and NO WARRANTY!
 
 Please read the documentation!
 
-GCC: Optimisation -ftree-vrp enabled by -O2 or -O3 breaks this code! Use -fno-tree-vrp if needed!
+Build with ./make_pdmconv (-O3, LTO, optionally PGO), the output does not depend on the optimisation.
 
 version 1 - 29.05.22
 */
@@ -47,9 +70,2681 @@ typedef struct __attribute__((__packed__))
 } wav_data_t;
 
 
+//reads exactly nb_bytes unless the file ends, false on error
+static bool read_all(const int fd, void * const data, const size_t nb_bytes, size_t * const nb_read)
+{
+	(*nb_read)=0;
+	while((*nb_read)<nb_bytes)
+	{
+		ssize_t n=read(fd, (uint8_t*)data+(*nb_read), nb_bytes-(*nb_read));
+		if(n<0 && errno==EINTR)
+			continue;
+		if(n<0)
+			return false;
+		if(n==0)
+			break;
+		(*nb_read)+=n;
+	}
+	return true;
+}
+
+//checks the headers of a single channel 16 bit wave file, the audio-data follows in fd
+//returns NULL if fine or what is wrong
+static char const * read_wav_header(const int fd, uint32_t * const nb_samples, uint16_t * const sample_rate)
+{
+	size_t nb_read;
+
+	wav_header_t header;
+	if(!read_all(fd, &header, sizeof(wav_header_t), &nb_read) || nb_read!=sizeof(wav_header_t))
+		return "reading file header failed";
+
+	if(memcmp(header.chunkID, "RIFF", 4))
+		return "not a wav file, invalid chunkID";
+
+	if(memcmp(header.riffType, "WAVE", 4))
+		return "not a wav file, invalid RIFFtype";
+
+	wav_fmt_t fmt;
+	if(!read_all(fd, &fmt, sizeof(wav_fmt_t), &nb_read) || nb_read!=sizeof(wav_fmt_t))
+		return "reading fmt block failed";
+
+	if(memcmp(fmt.fmt_sig, "fmt ", 4))
+		return "fmt block has invalid signature";
+
+	if(fmt.fmt_size!=16)
+		return "fmt block has wrong size";
+
+	if(fmt.fmt_tag!=0x0001)
+		return "wrong data format, only plain PCM supported";
+
+	if(fmt.channels!=1)
+		return "too many channels in file, only mono supported";
+
+	if(fmt.sample_rate!=8000 && fmt.sample_rate!=16000)
+		return "wrong sample rate, only 8kHz or 16kHz supported";
+
+	(*sample_rate)=fmt.sample_rate;
+
+	if(fmt.bits_per_sample!=16)
+		return "wrong number of bits per sample, only 16 bits supported";
+
+	wav_data_t wav_data;
+	if(!read_all(fd, &wav_data, sizeof(wav_data_t), &nb_read) || nb_read!=sizeof(wav_data_t))
+		return "reading header of wave data block failed";
+
+	if(memcmp(wav_data.data_sig, "data", 4))
+		return "header of wave data block has invalid signature";
+
+	(*nb_samples)=wav_data.length/(16/8);
+	if((*nb_samples)==0)
+		return "no audio-data, the file is empty";
+
+	return NULL;
+}
+
+#define WAV_HEADERS_SIZE (sizeof(wav_header_t)+sizeof(wav_fmt_t)+sizeof(wav_data_t)) //audio-data starts here
+
+//maps a single channel 16 bit wave file into memory, read only, unmap_wav() when done
+static int16_t const * map_wav(char const * const file_name, uint32_t * const nb_samples, uint16_t * const sample_rate)
+{
+	int fd=open(file_name, O_RDONLY);
+	if(fd<0)
+		err(1, "opening input file %s failed", file_name);
+
+	char const * error=read_wav_header(fd, nb_samples, sample_rate);
+	if(error)
+		errx(1, "%s: %s", file_name, error);
+
+	struct stat st;
+	if(fstat(fd, &st))
+		err(1, "reading input file %s failed", file_name);
+	size_t size=WAV_HEADERS_SIZE+(size_t)(*nb_samples)*sizeof(int16_t);
+	if((uint64_t)st.st_size<size)
+		errx(1, "%s: audio data is truncated", file_name);
+
+	uint8_t * map=mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if(map==MAP_FAILED)
+		err(1, "mapping input file %s failed", file_name);
+	madvise(map, size, MADV_SEQUENTIAL);
+	close(fd);
+
+	return (int16_t const *)&map[WAV_HEADERS_SIZE]; //44 bytes, aligned enough
+}
+
+static void unmap_wav(int16_t const * const data, const uint32_t nb_samples)
+{
+	munmap((uint8_t*)data-WAV_HEADERS_SIZE, WAV_HEADERS_SIZE+(size_t)nb_samples*sizeof(int16_t));
+}
+
+//reads a single channel 16 bit wave file into malloc'ed memory
+static int16_t * read_wav(char const * const file_name, uint32_t * const nb_samples, uint16_t * const sample_rate)
+{
+	int fd=open(file_name, O_RDONLY);
+	if(fd<0)
+		err(1, "opening input file %s failed", file_name);
+
+	char const * error=read_wav_header(fd, nb_samples, sample_rate);
+	if(error)
+		errx(1, "%s: %s", file_name, error);
+
+	int16_t * data=malloc((*nb_samples)*sizeof(int16_t));
+	if(!data)
+		err(1, "malloc for audio data of %s failed", file_name);
+
+	size_t nb_read;
+	if(!read_all(fd, data, (*nb_samples)*sizeof(int16_t), &nb_read) || nb_read!=(*nb_samples)*sizeof(int16_t))
+		err(1, "reading audio data from %s failed", file_name);
+
+	close(fd);
+
+	return data;
+}
+
+static uint16_t codec_code[PDM_CODEC_NB_TABLES][256];
+
+static void codec_build_codes(void)
+{
+	//canonical Huffman codes from the code lengths, must match pdmtables
+	uint8_t table;
+	for(table=0; table<PDM_CODEC_NB_TABLES; table++)
+	{
+		uint16_t code=0;
+		uint8_t previous_len=0;
+		bool first=true;
+		uint8_t len;
+		for(len=1; len<=PDM_CODEC_MAX_CODE_LENGTH; len++)
+		{
+			uint16_t s;
+			for(s=0; s<256; s++)
+			{
+				if(pdm_codec_length[table][s]!=len)
+					continue;
+				if(!first)
+					code++;
+				first=false;
+				code<<=(len-previous_len);
+				previous_len=len;
+				codec_code[table][s]=code;
+			}
+		}
+	}
+}
+
+//returns the number of bytes written to out, at most 2+PDM_CODEC_BLOCK_SIZE
+static uint16_t codec_encode_block(uint8_t const * const in, uint8_t * const out)
+{
+	uint8_t * payload=out+2;
+	uint16_t nb_bytes=0;
+	uint32_t bits=0;
+	uint8_t nb_bits=0;
+	uint8_t previous=0;
+	uint16_t i;
+
+	for(i=0; i<PDM_CODEC_BLOCK_SIZE; i++)
+	{
+		uint8_t table=pdm_codec_table_of_context[previous];
+		bits=(bits<<pdm_codec_length[table][in[i]])|codec_code[table][in[i]];
+		nb_bits+=pdm_codec_length[table][in[i]];
+		while(nb_bits>=8)
+		{
+			nb_bits-=8;
+			if(nb_bytes==PDM_CODEC_BLOCK_SIZE)
+				goto store;
+			payload[nb_bytes++]=bits>>nb_bits;
+		}
+		previous=in[i];
+	}
+
+	if(nb_bits)
+	{
+		if(nb_bytes==PDM_CODEC_BLOCK_SIZE)
+			goto store;
+		payload[nb_bytes++]=bits<<(8-nb_bits);
+	}
+
+	if(nb_bytes<PDM_CODEC_BLOCK_SIZE)
+	{
+		out[0]=nb_bytes&0xFF;
+		out[1]=nb_bytes>>8;
+		return 2+nb_bytes;
+	}
+
+store:
+	out[0]=PDM_CODEC_STORED&0xFF;
+	out[1]=PDM_CODEC_STORED>>8;
+	memcpy(payload, in, PDM_CODEC_BLOCK_SIZE);
+	return 2+PDM_CODEC_BLOCK_SIZE;
+}
+
+//scale to +-104 (about -1.8dB), the modulator of the AVR needs some headroom like every second-order modulator
+static void convert_pcm8(int16_t const * const data, const uint32_t nb_samples, int8_t * const data_pcm)
+{
+	uint32_t i;
+	for(i=0; i<nb_samples; i++)
+	{
+		int32_t s=(int32_t)data[i]*104;
+		data_pcm[i]=(int8_t)((s+(s<0?-16384:16384))/32768);
+	}
+}
+
+//second-order modulator, writes (2*oversampling_ratio*nb_samples+7)/8 bytes to data_out
+static void modulate(int16_t const * const data, const uint32_t nb_samples, const uint8_t oversampling_ratio, uint8_t * const data_out)
+{
+	pdmenc_t enc;
+	if(!pdmenc_init(&enc, oversampling_ratio))
+		errx(1, "invalid OSR %u", oversampling_ratio);
+
+	uint32_t index_in=0, index_out=0;
+	while(index_in<nb_samples)
+	{
+		index_in+=pdmenc_push_pcm(&enc, &data[index_in], nb_samples-index_in);
+		index_out+=pdmenc_pull_packed(&enc, &data_out[index_out], PDMENC_BUFFER_SIZE);
+	}
+
+	pdmenc_flush(&enc);
+	pdmenc_pull_packed(&enc, &data_out[index_out], PDMENC_BUFFER_SIZE);
+}
+
+//last block is padded with the idle pattern of the modulator, stream ends with PDM_CODEC_END and is padded to full sectors
+//max_two_blocks is the biggest size of 2 consecutive blocks, that's what the card must deliver while 2 buffers are played
+static uint8_t * compress(uint8_t const * const data_out, const uint32_t nb_bytes_output, uint32_t * const nb_bytes_compressed, uint32_t * const nb_blocks_stored, uint32_t * const max_two_blocks)
+{
+	uint32_t nb_blocks=(nb_bytes_output+PDM_CODEC_BLOCK_SIZE-1)/PDM_CODEC_BLOCK_SIZE;
+	uint8_t * data_compressed=malloc((nb_blocks*(2+PDM_CODEC_BLOCK_SIZE)+2+511)/512*512);
+	if(!data_compressed)
+		err(1, "malloc for compressed data failed");
+
+	codec_build_codes();
+
+	(*nb_bytes_compressed)=0;
+	(*nb_blocks_stored)=0;
+	(*max_two_blocks)=0;
+	uint16_t previous_sz=0;
+	uint32_t block;
+	for(block=0; block<nb_blocks; block++)
+	{
+		uint8_t block_data[PDM_CODEC_BLOCK_SIZE];
+		uint32_t nb=nb_bytes_output-block*PDM_CODEC_BLOCK_SIZE;
+		if(nb>PDM_CODEC_BLOCK_SIZE)
+			nb=PDM_CODEC_BLOCK_SIZE;
+		memset(block_data, 0xAA, PDM_CODEC_BLOCK_SIZE);
+		memcpy(block_data, &data_out[block*PDM_CODEC_BLOCK_SIZE], nb);
+		uint16_t sz=codec_encode_block(block_data, &data_compressed[*nb_bytes_compressed]);
+		if(sz==2+PDM_CODEC_BLOCK_SIZE)
+			(*nb_blocks_stored)++;
+		(*nb_bytes_compressed)+=sz;
+		if(previous_sz+sz>(*max_two_blocks))
+			(*max_two_blocks)=previous_sz+sz;
+		previous_sz=sz;
+	}
+
+	data_compressed[(*nb_bytes_compressed)++]=PDM_CODEC_END&0xFF;
+	data_compressed[(*nb_bytes_compressed)++]=PDM_CODEC_END>>8;
+	while((*nb_bytes_compressed)%512)
+		data_compressed[(*nb_bytes_compressed)++]=0;
+
+	return data_compressed;
+}
+
+//false if this OSR can't be done with this clock
+static bool calc_ubbr(const uint32_t f_cpu, const uint16_t sample_rate, const uint8_t oversampling_ratio, float * const ubbr_value_float, uint16_t * const ubbr_value)
+{
+	(*ubbr_value_float)=(float)f_cpu/(2*sample_rate*oversampling_ratio*2)-1;
+	if((*ubbr_value_float)<-0.5 || (*ubbr_value_float)>4095)
+		return false;
+	(*ubbr_value)=(uint16_t)((*ubbr_value_float)+0.5);
+	return true;
+}
+
+static void make_header(uint8_t * const sector, const uint8_t codec, const uint8_t osr, const uint16_t sample_rate, const uint16_t ubbr, const uint32_t f_cpu, const uint32_t nb_bytes, const uint32_t nb_sectors, const uint32_t loop_start, const uint32_t loop_end)
+{
+	memset(sector, 0, 512);
+
+	pdm_header_t * header=(pdm_header_t*)sector;
+	memcpy(header->magic, PDM_HEADER_MAGIC, 4);
+	header->version=PDM_HEADER_VERSION;
+	header->codec=codec;
+	header->osr=osr;
+	header->sample_rate=sample_rate;
+	header->ubbr=ubbr;
+	header->f_cpu=f_cpu;
+	header->nb_bytes=nb_bytes;
+	header->nb_sectors=nb_sectors;
+	header->loop_start=loop_start;
+	header->loop_end=loop_end;
+	header->checksum=pdm_header_checksum(header);
+}
+
+static void write_header(FILE * const out, const uint8_t codec, const uint8_t osr, const uint16_t sample_rate, const uint16_t ubbr, const uint32_t f_cpu, const uint32_t nb_bytes, const uint32_t nb_sectors)
+{
+	uint8_t sector[512];
+	make_header(sector, codec, osr, sample_rate, ubbr, f_cpu, nb_bytes, nb_sectors, 0, 0);
+
+	if(fwrite(sector, sizeof(uint8_t), 512, out)!=512)
+		err(1, "writing header failed");
+}
+
+//--decode: unpack a file made by pdmconv back to PCM to check the quality without flashing and listening
+
+#define DECODE_CIC_ORDER 4 //CIC decimates from the bitrate 2*OSR*sample_rate to 2*sample_rate, decimate() is written for 4
+#define DECODE_FIR_TAPS 127 //FIR at 2*sample_rate, lowpass at sample_rate/2 and decimation by 2, odd
+#define DECODE_FIR_KAISER_BETA 7.0 //about 70dB of stopband attenuation
+#define DECODE_MAX_LAG_MS 20 //search range for the delay between source and decoded audio
+#define DECODE_LAG_SEARCH_S 10 //the delay is searched in this many seconds at the beginning
+#define DECODE_FIT_TAPS 8 //small FIR fitted from source to decoded audio, absorbs gain, fractional delay and passband ripple
+
+//every regular output is removed before being written, so a file that shares its inode with another one (a hardlink made by the user or by an older version of the cache) is never overwritten in place
+//false if the output is not a regular file (like /dev/sdX), the cache is not used then
+static bool prepare_output(char const * const file_name)
+{
+	struct stat st;
+	if(lstat(file_name, &st))
+		return true;
+	if(!S_ISREG(st.st_mode))
+		return false;
+	if(unlink(file_name))
+		err(1, "removing old output file %s failed", file_name);
+	return true;
+}
+
+static void write_wav(char const * const file_name, int16_t const * const data, const uint32_t nb_samples, const uint16_t sample_rate)
+{
+	wav_header_t header;
+	wav_fmt_t fmt;
+	wav_data_t wav_data;
+
+	memcpy(header.chunkID, "RIFF", 4);
+	header.ChunkSize=sizeof(wav_header_t)-8+sizeof(wav_fmt_t)+sizeof(wav_data_t)+nb_samples*sizeof(int16_t);
+	memcpy(header.riffType, "WAVE", 4);
+
+	memcpy(fmt.fmt_sig, "fmt ", 4);
+	fmt.fmt_size=16;
+	fmt.fmt_tag=0x0001;
+	fmt.channels=1;
+	fmt.sample_rate=sample_rate;
+	fmt.bytes_per_sec=sample_rate*sizeof(int16_t);
+	fmt.block_align=sizeof(int16_t);
+	fmt.bits_per_sample=16;
+
+	memcpy(wav_data.data_sig, "data", 4);
+	wav_data.length=nb_samples*sizeof(int16_t);
+
+	prepare_output(file_name);
+	FILE * out=fopen(file_name, "wb");
+	if(!out)
+		err(1, "creating output file %s failed", file_name);
+
+	if(fwrite(&header, sizeof(wav_header_t), 1, out)!=1 || fwrite(&fmt, sizeof(wav_fmt_t), 1, out)!=1 || fwrite(&wav_data, sizeof(wav_data_t), 1, out)!=1)
+		err(1, "writing header of %s failed", file_name);
+
+	if(fwrite(data, sizeof(int16_t), nb_samples, out)!=nb_samples)
+		err(1, "writing output file %s failed", file_name);
+
+	fclose(out);
+}
+
+//same as codec_decode_block() of the firmware but from memory, returns the number of bytes used or 0 at the end of the data
+static uint32_t codec_decode_block_mem(uint8_t const * const in, const uint32_t size, uint8_t * const out)
+{
+	if(size<2)
+		return 0;
+
+	uint16_t header=in[0]|((uint16_t)in[1]<<8);
+
+	if(header==PDM_CODEC_END)
+		return 0;
+
+	if(header==PDM_CODEC_STORED)
+	{
+		if(size<2+PDM_CODEC_BLOCK_SIZE)
+			errx(1, "compressed data is truncated");
+		memcpy(out, &in[2], PDM_CODEC_BLOCK_SIZE);
+		return 2+PDM_CODEC_BLOCK_SIZE;
+	}
+
+	if(header>PDM_CODEC_BLOCK_SIZE || size<2u+header)
+		errx(1, "compressed data is corrupted");
+
+	uint8_t const * payload=in+2;
+	uint32_t pos=0;
+	uint32_t window=0; //next bits of the payload, MSB first
+	uint8_t nb_bits=0;
+	uint8_t previous=0;
+	uint16_t i;
+
+	for(i=0; i<PDM_CODEC_BLOCK_SIZE; i++)
+	{
+		while(nb_bits<=24)
+		{
+			window|=(uint32_t)(pos<header?payload[pos]:0)<<(24-nb_bits);
+			pos++;
+			nb_bits+=8;
+		}
+
+		uint8_t table=pdm_codec_table_of_context[previous];
+		uint8_t peek=window>>24;
+		uint8_t len=pdm_codec_lut_len[table][peek];
+		uint8_t symbol=0;
+
+		if(len)
+		{
+			symbol=pdm_codec_lut_sym[table][peek];
+			window<<=len;
+			nb_bits-=len;
+		}
+		else
+		{
+			//long code, continue bit by bit
+			uint16_t code=peek;
+			window<<=PDM_CODEC_LUT_BITS;
+			nb_bits-=PDM_CODEC_LUT_BITS;
+
+			uint8_t l;
+			for(l=0; l<PDM_CODEC_MAX_CODE_LENGTH-PDM_CODEC_LUT_BITS; l++)
+			{
+				code=(code<<1)|(window>>31);
+				window<<=1;
+				nb_bits--;
+
+				uint16_t offset=code-pdm_codec_long_first[table][l];
+				if(offset<pdm_codec_long_count[table][l])
+				{
+					symbol=pdm_codec_long_symbols[pdm_codec_long_index[table][l]+offset];
+					break;
+				}
+			}
+			if(l==PDM_CODEC_MAX_CODE_LENGTH-PDM_CODEC_LUT_BITS)
+				errx(1, "compressed data is corrupted");
+		}
+
+		out[i]=symbol;
+		previous=symbol;
+	}
+
+	return 2+header;
+}
+
+//decodes all blocks into out (or only counts them with out==NULL) and returns their number
+//with loops an END is not the end of the data, like the firmware the decoding continues at the next sector
+static uint32_t codec_decode_mem(uint8_t const * const in, const uint32_t size, const bool loops, uint8_t * const out)
+{
+	uint8_t block[PDM_CODEC_BLOCK_SIZE];
+	uint32_t nb_blocks=0;
+	uint32_t pos=0;
+
+	while(pos<size)
+	{
+		uint32_t used=codec_decode_block_mem(&in[pos], size-pos, out?&out[nb_blocks*PDM_CODEC_BLOCK_SIZE]:block);
+		if(used)
+		{
+			pos+=used;
+			nb_blocks++;
+		}
+		else if(loops)
+			pos=(pos+2+511)/512*512;
+		else
+			break;
+	}
+
+	return nb_blocks;
+}
+
+#define AVR_INTEGRATOR1_LIMIT 2048 //PCM_INTEGRATOR1_LIMIT of the firmware
+#define AVR_INTEGRATOR2_LIMIT 8192 //PCM_INTEGRATOR2_LIMIT of the firmware
+
+//same as modulate_byte() of the firmware with PCM_MODE, so --decode hears what the AVR plays
+static uint8_t avr_modulate_byte(int16_t * const integrator1, int16_t * const integrator2, const int8_t sample)
+{
+	uint8_t packed=0;
+	uint8_t bit;
+
+	if((*integrator1)>AVR_INTEGRATOR1_LIMIT)
+		(*integrator1)=AVR_INTEGRATOR1_LIMIT;
+	else if((*integrator1)<-AVR_INTEGRATOR1_LIMIT)
+		(*integrator1)=-AVR_INTEGRATOR1_LIMIT;
+	if((*integrator2)>AVR_INTEGRATOR2_LIMIT)
+		(*integrator2)=AVR_INTEGRATOR2_LIMIT;
+	else if((*integrator2)<-AVR_INTEGRATOR2_LIMIT)
+		(*integrator2)=-AVR_INTEGRATOR2_LIMIT;
+
+	for(bit=0; bit<8; bit++)
+	{
+		(*integrator2)+=(*integrator1);
+		packed<<=1;
+		if((*integrator2)<0)
+		{
+			(*integrator1)+=(int16_t)sample+128;
+			(*integrator2)+=128;
+		}
+		else
+		{
+			packed|=1;
+			(*integrator1)+=(int16_t)sample-127;
+			(*integrator2)-=127;
+		}
+	}
+
+	return packed;
+}
+
+//what the AVR plays for nb_samples of PCM8, 2*osr/8 bytes per sample
+static void avr_modulate(int8_t const * const data_pcm, const uint32_t nb_samples, const uint8_t osr, uint8_t * const pdm)
+{
+	const uint8_t bytes_per_sample=2*osr/8;
+	int16_t integrator1=0, integrator2=0;
+	uint32_t i;
+	uint8_t j;
+	for(i=0; i<nb_samples; i++)
+		for(j=0; j<bytes_per_sample; j++)
+			pdm[i*bytes_per_sample+j]=avr_modulate_byte(&integrator1, &integrator2, data_pcm[i]);
+}
+
+//returns the packed PDM-data of a file (without header) in malloc'ed memory, whatever the codec was
+//a file with a loop is returned the way the firmware plays it until after the first time it goes back, so the part before the loop and the loop twice
+static uint8_t * load_pdm(char const * const file_name, uint8_t * const osr, uint16_t * const sample_rate, uint8_t codec, uint32_t * const nb_bytes_pdm, bool * const loops)
+{
+	FILE * inp=fopen(file_name, "rb");
+	if(!inp)
+		err(1, "opening input file %s failed", file_name);
+
+	fseek(inp, 0, SEEK_END);
+	long size_file=ftell(inp);
+	rewind(inp);
+	if(size_file<=0)
+		errx(1, "%s is empty", file_name);
+
+	uint8_t * file=malloc(size_file);
+	if(!file)
+		err(1, "malloc for input data failed");
+
+	if(fread(file, sizeof(uint8_t), size_file, inp)!=(size_t)size_file)
+		err(1, "reading input file %s failed", file_name);
+
+	fclose(inp);
+
+	uint8_t * data=file;
+	uint32_t nb_bytes=size_file;
+	uint8_t * played=NULL;
+	(*loops)=false;
+
+	pdm_header_t const * header=(pdm_header_t const *)file;
+	if(size_file>=512 && !memcmp(header->magic, PDM_HEADER_MAGIC, 4))
+	{
+		if(header->version!=PDM_HEADER_VERSION || header->checksum!=pdm_header_checksum(header))
+			errx(1, "header of %s is invalid", file_name);
+		if((uint32_t)size_file<512+header->nb_sectors*512)
+			errx(1, "%s is truncated", file_name);
+		(*osr)=header->osr;
+		(*sample_rate)=header->sample_rate;
+		codec=header->codec;
+		data=file+512;
+		nb_bytes=header->nb_sectors*512;
+		printf("Header: %uHz OSR %u codec %u UBBR %u for %.3fMHz\n", header->sample_rate, header->osr, header->codec, header->ubbr, header->f_cpu/1E6);
+
+		if(header->loop_end)
+		{
+			if(header->loop_start>=header->loop_end || header->loop_end>header->nb_sectors)
+				errx(1, "loop of %s is invalid", file_name);
+			printf("Loop: sectors %u to %u, decoding it twice\n", header->loop_start, header->loop_end);
+			uint32_t nb_before=header->loop_end*512;
+			uint32_t nb_loop=(header->loop_end-header->loop_start)*512;
+			played=malloc(nb_before+nb_loop);
+			if(!played)
+				err(1, "malloc for PDM-data failed");
+			memcpy(played, data, nb_before);
+			memcpy(played+nb_before, data+header->loop_start*512, nb_loop);
+			data=played;
+			nb_bytes=nb_before+nb_loop;
+			(*loops)=true;
+		}
+	}
+	else
+	{
+		if((*osr)==0 || (*sample_rate)==0)
+			errx(1, "%s has no header, --osr and --rate are needed", file_name);
+		printf("No header, using OSR %u and %uHz\n", *osr, *sample_rate);
+	}
+
+	uint8_t * pdm;
+
+	switch(codec)
+	{
+		case PDM_HEADER_CODEC_NONE:
+			pdm=malloc(nb_bytes);
+			if(!pdm)
+				err(1, "malloc for PDM-data failed");
+			memcpy(pdm, data, nb_bytes);
+			if(data!=file && !(*loops))
+				nb_bytes=header->nb_bytes; //without the padding
+			break;
+
+		case PDM_HEADER_CODEC_HUFFMAN:
+		{
+			uint32_t nb_blocks=codec_decode_mem(data, nb_bytes, *loops, NULL);
+
+			pdm=malloc(nb_blocks*PDM_CODEC_BLOCK_SIZE);
+			if(!pdm)
+				err(1, "malloc for PDM-data failed");
+
+			codec_decode_mem(data, nb_bytes, *loops, pdm);
+
+			nb_bytes=nb_blocks*PDM_CODEC_BLOCK_SIZE;
+			if(data!=file && !(*loops) && header->nb_bytes<nb_bytes)
+				nb_bytes=header->nb_bytes;
+			break;
+		}
+
+		case PDM_HEADER_CODEC_PCM8:
+		{
+			if((*osr)%4)
+				errx(1, "OSR must be a multiple of 4 for PCM8");
+			if(data!=file && !(*loops))
+				nb_bytes=header->nb_bytes;
+			uint8_t bytes_per_sample=2*(*osr)/8;
+			pdm=malloc(nb_bytes*bytes_per_sample);
+			if(!pdm)
+				err(1, "malloc for PDM-data failed");
+			avr_modulate((int8_t const *)data, nb_bytes, *osr, pdm);
+			nb_bytes*=bytes_per_sample;
+			break;
+		}
+
+		default:
+			errx(1, "unknown codec %u", codec);
+			break;
+	}
+
+	free(file);
+	free(played);
+
+	(*nb_bytes_pdm)=nb_bytes;
+	return pdm;
+}
+
+static double bessel_i0(const double x)
+{
+	double sum=1, term=1;
+	uint8_t k;
+	for(k=1; k<50; k++)
+	{
+		term*=(x/(2*k))*(x/(2*k));
+		sum+=term;
+	}
+	return sum;
+}
+
+//response of the CIC at frequency nu (relative to its output rate), 1 at DC
+static double cic_response(const double nu, const uint8_t decimation)
+{
+	if(nu==0)
+		return 1;
+	return pow(sin(M_PI*nu)/(decimation*sin(M_PI*nu/decimation)), DECODE_CIC_ORDER);
+}
+
+//Kaiser-windowed lowpass at a quarter of its rate, passband shaped as the inverse of the CIC droop
+static void design_fir(double * const h, const uint8_t decimation)
+{
+	const uint16_t nb_steps=1000;
+	const double nu_cutoff=0.25;
+	double sum=0;
+	uint16_t k, j;
+
+	for(k=0; k<DECODE_FIR_TAPS; k++)
+	{
+		double t=k-(DECODE_FIR_TAPS-1)/2.0;
+		double acc=0;
+		for(j=0; j<nb_steps; j++)
+		{
+			double nu=(j+0.5)*nu_cutoff/nb_steps;
+			acc+=cos(2*M_PI*nu*t)/cic_response(nu, decimation);
+		}
+		double r=t/((DECODE_FIR_TAPS-1)/2.0);
+		h[k]=2*acc*nu_cutoff/nb_steps*bessel_i0(DECODE_FIR_KAISER_BETA*sqrt(1-r*r))/bessel_i0(DECODE_FIR_KAISER_BETA);
+		sum+=h[k];
+	}
+
+	for(k=0; k<DECODE_FIR_TAPS; k++)
+		h[k]/=sum;
+}
+
+//CIC from the bitrate down to 2*sample_rate, then FIR down to sample_rate; output is +-1 for full scale and not delayed by the FIR
+static float * decimate(uint8_t const * const pdm, const uint32_t nb_bytes, const uint8_t osr, uint32_t * const nb_samples)
+{
+	const uint16_t pad=(DECODE_FIR_TAPS+1)/2;
+	uint32_t nb_cic=(uint64_t)nb_bytes*8/osr/2*2;
+	(*nb_samples)=nb_cic/2;
+
+	//CIC output split into even and odd samples with zeros around, so the FIR needs no bounds checks
+	float * even=calloc((*nb_samples)+2*pad, sizeof(float));
+	float * odd=calloc((*nb_samples)+2*pad, sizeof(float));
+	float * out=malloc((*nb_samples)*sizeof(float));
+	if(!even || !odd || !out)
+		err(1, "malloc for decimation failed");
+
+	//integrators after 8 bits starting from 0, so a byte without a decimation point is a single step
+	//unsigned wrap-around is fine for a CIC as long as the result fits, osr^DECODE_CIC_ORDER does
+	uint64_t byte_step[256][DECODE_CIC_ORDER];
+	uint16_t b;
+	uint8_t s, bit;
+	for(b=0; b<256; b++)
+	{
+		uint64_t integrator[DECODE_CIC_ORDER]={0};
+		for(bit=0; bit<8; bit++)
+		{
+			integrator[0]+=(b&(0x80>>bit))?1:-1;
+			for(s=1; s<DECODE_CIC_ORDER; s++)
+				integrator[s]+=integrator[s-1];
+		}
+		memcpy(byte_step[b], integrator, sizeof(integrator));
+	}
+
+	uint64_t i1=0, i2=0, i3=0, i4=0;
+	uint64_t comb[DECODE_CIC_ORDER]={0};
+	const float scale=1.0/pow(osr, DECODE_CIC_ORDER);
+	uint16_t bits_left=osr; //until the next decimation point
+	uint32_t i, n=0;
+
+	for(i=0; i<nb_bytes && n<nb_cic; i++)
+	{
+		if(bits_left>8)
+		{
+			//4th order only: integrator k gets the previous ones weighted by binomial coefficients
+			i4+=8*i3+36*i2+120*i1+byte_step[pdm[i]][3];
+			i3+=8*i2+36*i1+byte_step[pdm[i]][2];
+			i2+=8*i1+byte_step[pdm[i]][1];
+			i1+=byte_step[pdm[i]][0];
+			bits_left-=8;
+			continue;
+		}
+
+		for(bit=0; bit<8; bit++)
+		{
+			i1+=(pdm[i]&(0x80>>bit))?1:-1;
+			i2+=i1;
+			i3+=i2;
+			i4+=i3;
+			if(--bits_left==0)
+			{
+				bits_left=osr;
+				uint64_t v=i4;
+				for(s=0; s<DECODE_CIC_ORDER; s++)
+				{
+					uint64_t previous=comb[s];
+					comb[s]=v;
+					v-=previous;
+				}
+				if(n<nb_cic)
+				{
+					if(n&1)
+						odd[pad+n/2]=(int64_t)v*scale;
+					else
+						even[pad+n/2]=(int64_t)v*scale;
+					n++;
+				}
+			}
+		}
+	}
+
+	double h_design[DECODE_FIR_TAPS];
+	design_fir(h_design, osr);
+
+	//out[i]=sum h[k]*cic[2*i+(DECODE_FIR_TAPS-1)/2-k], centered so the FIR adds no delay
+	//done tap by tap over blocks of outputs, the inner loop is plain enough for the compiler to vectorise
+	const uint16_t block=256;
+	for(i=0; i<(*nb_samples); i+=block)
+	{
+		uint32_t nb=(*nb_samples)-i;
+		if(nb>block)
+			nb=block;
+		float * o=&out[i];
+		memset(o, 0, nb*sizeof(float));
+
+		uint16_t k;
+		for(k=0; k<DECODE_FIR_TAPS; k++)
+		{
+			int16_t offset=(DECODE_FIR_TAPS-1)/2-k; //in samples of the CIC
+			float const * in=((offset&1)?odd:even)+pad+i+(offset>>1); //arithmetic shift rounds towards -inf
+			const float h=h_design[k];
+			uint32_t j;
+			for(j=0; j<nb; j++)
+				o[j]+=h*in[j];
+		}
+	}
+
+	free(even);
+	free(odd);
+
+	return out;
+}
+
+//solves a*x=b for a small symmetric system by Gaussian elimination, returns false if singular
+static bool solve(double a[DECODE_FIT_TAPS][DECODE_FIT_TAPS], double * const b, double * const x)
+{
+	uint8_t i, j, k;
+
+	for(i=0; i<DECODE_FIT_TAPS; i++)
+	{
+		uint8_t pivot=i;
+		for(j=i+1; j<DECODE_FIT_TAPS; j++)
+			if(fabs(a[j][i])>fabs(a[pivot][i]))
+				pivot=j;
+		if(fabs(a[pivot][i])<1E-12)
+			return false;
+		for(k=0; k<DECODE_FIT_TAPS; k++)
+		{
+			double t=a[i][k];
+			a[i][k]=a[pivot][k];
+			a[pivot][k]=t;
+		}
+		double t=b[i];
+		b[i]=b[pivot];
+		b[pivot]=t;
+
+		for(j=i+1; j<DECODE_FIT_TAPS; j++)
+		{
+			double f=a[j][i]/a[i][i];
+			for(k=i; k<DECODE_FIT_TAPS; k++)
+				a[j][k]-=f*a[i][k];
+			b[j]-=f*b[i];
+		}
+	}
+
+	for(i=DECODE_FIT_TAPS; i-->0;)
+	{
+		double acc=b[i];
+		for(k=i+1; k<DECODE_FIT_TAPS; k++)
+			acc-=a[i][k]*x[k];
+		x[i]=acc/a[i][i];
+	}
+
+	return true;
+}
+
+typedef struct
+{
+	int32_t delay; //samples
+	double gain; //dB
+	double snr; //dB
+	double thd_n; //ratio, not %
+	double noise; //dBFS
+} quality_t;
+
+//compares decoded audio to the source: the residual after fitting the source to the decoded audio is noise and distortion
+static quality_t analyse(float const * const decoded, const uint32_t nb_decoded, int16_t const * const source, const uint32_t nb_source, const uint16_t sample_rate, const uint16_t max_lag_ms)
+{
+	uint32_t n=nb_decoded<nb_source?nb_decoded:nb_source;
+	int32_t max_lag=(uint32_t)sample_rate*max_lag_ms/1000;
+	int32_t lag, best_lag=0;
+	double best=-1;
+	uint32_t i;
+	uint16_t l;
+
+	if(n<=(uint32_t)(2*(max_lag+DECODE_FIT_TAPS)))
+		errx(1, "not enough audio to compare");
+
+	uint32_t end_search=n-max_lag;
+	if(end_search>(uint32_t)sample_rate*DECODE_LAG_SEARCH_S)
+		end_search=(uint32_t)sample_rate*DECODE_LAG_SEARCH_S;
+
+	//delay of decoded against source by cross-correlation, shortest first so periodic sources don't get a delay of some periods
+	for(l=0; l<=2*max_lag; l++)
+	{
+		lag=(l&1)?-(int32_t)(l+1)/2:(int32_t)l/2;
+		double acc=0;
+		for(i=max_lag; i<end_search; i++)
+			acc+=decoded[i]*source[i-lag];
+		if(fabs(acc)>1.01*best)
+		{
+			best=fabs(acc);
+			best_lag=lag;
+		}
+	}
+
+	//least squares fit of a short FIR around that delay
+	uint32_t first=max_lag+DECODE_FIT_TAPS, last=n-max_lag-DECODE_FIT_TAPS;
+	double a[DECODE_FIT_TAPS][DECODE_FIT_TAPS]={{0}};
+	double b[DECODE_FIT_TAPS]={0};
+	double x[DECODE_FIT_TAPS]={0};
+	uint8_t j, k;
+
+	for(i=first; i<last; i++)
+	{
+		double r[DECODE_FIT_TAPS];
+		for(j=0; j<DECODE_FIT_TAPS; j++)
+			r[j]=source[i-best_lag+DECODE_FIT_TAPS/2-j]/32768.0;
+		for(j=0; j<DECODE_FIT_TAPS; j++)
+		{
+			b[j]+=r[j]*decoded[i];
+			for(k=0; k<DECODE_FIT_TAPS; k++)
+				a[j][k]+=r[j]*r[k];
+		}
+	}
+
+	double power_signal=0, power_residual=0, power_decoded=0, power_source=0;
+
+	if(!solve(a, b, x))
+		memset(x, 0, sizeof(x)); //silent source, everything is noise
+
+	for(i=first; i<last; i++)
+	{
+		double fit=0;
+		for(j=0; j<DECODE_FIT_TAPS; j++)
+			fit+=x[j]*source[i-best_lag+DECODE_FIT_TAPS/2-j]/32768.0;
+		power_signal+=fit*fit;
+		power_residual+=(decoded[i]-fit)*(decoded[i]-fit);
+		power_decoded+=decoded[i]*decoded[i];
+		power_source+=(source[i]/32768.0)*(source[i]/32768.0);
+	}
+
+	power_signal/=last-first;
+	power_residual/=last-first;
+	power_decoded/=last-first;
+	power_source/=last-first;
+
+	quality_t quality;
+	quality.delay=best_lag;
+	quality.gain=10*log10(power_signal/power_source);
+	quality.snr=10*log10(power_signal/power_residual);
+	quality.thd_n=sqrt(power_residual/power_decoded);
+	quality.noise=10*log10(power_residual/0.5); //0dBFS is a full scale sine
+	return quality;
+}
+
+static int decode(char const * const input_file_name, char const * const output_file_name, char const * const source_file_name, uint8_t osr, uint16_t sample_rate, const uint8_t codec)
+{
+	clock_t start=clock();
+
+	uint32_t nb_bytes;
+	bool loops;
+	uint8_t * pdm=load_pdm(input_file_name, &osr, &sample_rate, codec, &nb_bytes, &loops);
+
+	uint32_t nb_samples;
+	float * decoded=decimate(pdm, nb_bytes, osr, &nb_samples);
+
+	double seconds=(double)(clock()-start)/CLOCKS_PER_SEC;
+	printf("Decoded %u bytes of PDM-data to %u samples at %uHz in %.2fs (%.0fx realtime)\n\n", nb_bytes, nb_samples, sample_rate, seconds, (double)nb_samples/sample_rate/(seconds>0?seconds:1E-6));
+
+	int16_t * pcm=malloc(nb_samples*sizeof(int16_t));
+	if(!pcm)
+		err(1, "malloc for output data failed");
+
+	uint32_t i;
+	for(i=0; i<nb_samples; i++)
+	{
+		double s=round(decoded[i]*32768);
+		pcm[i]=s>32767?32767:(s<-32768?-32768:s);
+	}
+
+	write_wav(output_file_name, pcm, nb_samples, sample_rate);
+
+	if(source_file_name && loops)
+		printf("No comparison with %s, the file loops and it contains silence and copies of the loop for the alignment\n\n", source_file_name);
+	else if(source_file_name)
+	{
+		uint32_t nb_samples_source;
+		uint16_t sample_rate_source;
+		int16_t * source=read_wav(source_file_name, &nb_samples_source, &sample_rate_source);
+		if(sample_rate_source!=sample_rate)
+			errx(1, "sample rate of %s is %uHz, not %uHz", source_file_name, sample_rate_source, sample_rate);
+		if(nb_samples!=nb_samples_source)
+			printf("Warning: decoded audio has %u samples, source %u\n", nb_samples, nb_samples_source);
+		quality_t q=analyse(decoded, nb_samples, source, nb_samples_source, sample_rate, DECODE_MAX_LAG_MS);
+		printf("Delay %d samples, gain %.2fdB\n", q.delay, q.gain);
+		printf("SNR: %.1fdB\n", q.snr);
+		printf("THD+N: %.3f%% (%.1fdB)\n", 100*q.thd_n, 20*log10(q.thd_n));
+		printf("In-band noise (0 to %uHz): %.1fdBFS\n\n", sample_rate/2, q.noise);
+		free(source);
+	}
+
+	free(pdm);
+	free(decoded);
+	free(pcm);
+
+	return 0;
+}
+
+//--auto: the cheapest OSR and format for a card that still reaches a given quality
+
+#define AUTO_CARD_FS 100000 //bytes/s with kittenFS32 and a decent card, that's OSR 48 at 8kHz or 26 at 16kHz
+#define AUTO_CARD_RAW 140000 //bytes/s without file system, that's OSR 70 at 8kHz or 35 at 16kHz
+#define AUTO_PCM8_CYCLES_PER_BIT 41 //modulator of the AVR with PCM_MODE including the clamping of the integrators, that's OSR 28 at 8kHz or 12 at 16kHz with 20MHz
+#define AUTO_MAX_RATE_ERROR 0.01 //UBBR is an integer, only OSR that give a playback rate this close are used
+#define AUTO_EXCERPT_CHUNKS 10 //longer files are judged on this many chunks of 1s spread over the file
+#define AUTO_MAX_LAG_MS 2 //the delay of modulator and decimation is about 1 sample
+
+#define AUTO_PLAIN (1<<0)
+#define AUTO_COMPRESSED (1<<1)
+#define AUTO_PCM8 (1<<2)
+
+static char const * const auto_format_names[]={ "plain", "compressed", "pcm8" };
+
+//parses a comma separated list of auto_format_names, returns 0 if something is wrong
+static uint8_t auto_parse_formats(char const * const list)
+{
+	char copy[100];
+	strncpy(copy, list, sizeof(copy)-1);
+	copy[sizeof(copy)-1]='\0';
+
+	uint8_t formats=0;
+	char * token;
+	for(token=strtok(copy, ","); token; token=strtok(NULL, ","))
+	{
+		uint8_t f;
+		for(f=0; f<3; f++)
+			if(!strcmp(token, auto_format_names[f]))
+				break;
+		if(f==3)
+			return 0;
+		formats|=(1<<f);
+	}
+
+	return formats;
+}
+
+//the whole file or AUTO_EXCERPT_CHUNKS seconds of it, in malloc'ed memory
+static int16_t * auto_make_excerpt(int16_t const * const data, const uint32_t nb_samples, const uint16_t sample_rate, uint32_t * const nb_excerpt)
+{
+	uint32_t nb=nb_samples;
+	if(nb>(uint32_t)AUTO_EXCERPT_CHUNKS*sample_rate)
+		nb=(uint32_t)AUTO_EXCERPT_CHUNKS*sample_rate;
+
+	int16_t * excerpt=malloc(nb*sizeof(int16_t));
+	if(!excerpt)
+		err(1, "malloc for excerpt failed");
+
+	if(nb==nb_samples)
+		memcpy(excerpt, data, nb*sizeof(int16_t));
+	else
+	{
+		uint8_t c;
+		for(c=0; c<AUTO_EXCERPT_CHUNKS; c++)
+		{
+			uint32_t start=(uint64_t)(nb_samples-sample_rate)*c/(AUTO_EXCERPT_CHUNKS-1);
+			memcpy(&excerpt[c*sample_rate], &data[start], sample_rate*sizeof(int16_t));
+		}
+	}
+
+	(*nb_excerpt)=nb;
+	return excerpt;
+}
+
+//SNR as --decode would report it, for PDM-data or PCM8 modulated by the AVR
+static double auto_snr(int16_t const * const excerpt, const uint32_t nb_samples, const uint16_t sample_rate, const uint8_t osr, const bool pcm8)
+{
+	uint32_t nb_bytes=((uint64_t)2*osr*nb_samples+7)/8;
+	uint8_t * pdm=malloc(nb_bytes);
+	if(!pdm)
+		err(1, "malloc for PDM-data failed");
+
+	if(pcm8)
+	{
+		int8_t * data_pcm=malloc(nb_samples*sizeof(int8_t));
+		if(!data_pcm)
+			err(1, "malloc for PCM-data failed");
+		convert_pcm8(excerpt, nb_samples, data_pcm);
+		avr_modulate(data_pcm, nb_samples, osr, pdm);
+		free(data_pcm);
+	}
+	else
+		modulate(excerpt, nb_samples, osr, pdm);
+
+	uint32_t nb_decoded;
+	float * decoded=decimate(pdm, nb_bytes, osr, &nb_decoded);
+	quality_t quality=analyse(decoded, nb_decoded, excerpt, nb_samples, sample_rate, AUTO_MAX_LAG_MS);
+
+	free(pdm);
+	free(decoded);
+
+	return quality.snr;
+}
+
+//bytes/s the card must deliver at the worst place of the compressed file, 2 blocks are played while the next one is read
+static double auto_compressed_rate(int16_t const * const data, const uint32_t nb_samples, const uint16_t sample_rate, const uint8_t osr)
+{
+	uint32_t nb_bytes=((uint64_t)2*osr*nb_samples+7)/8;
+	uint8_t * pdm=malloc(nb_bytes);
+	if(!pdm)
+		err(1, "malloc for PDM-data failed");
+
+	modulate(data, nb_samples, osr, pdm);
+
+	uint32_t nb_bytes_compressed, nb_blocks_stored, max_two_blocks;
+	uint8_t * data_compressed=compress(pdm, nb_bytes, &nb_bytes_compressed, &nb_blocks_stored, &max_two_blocks);
+
+	free(pdm);
+	free(data_compressed);
+
+	double seconds_per_block=PDM_CODEC_BLOCK_SIZE*8.0/(2.0*osr*sample_rate);
+	return max_two_blocks/(2*seconds_per_block);
+}
+
+//searches the allowed formats for the lowest OSR that reaches min_snr and fits the budget, picks the format that needs the fewest bytes/s from the card
+static bool auto_select(int16_t const * const data, const uint32_t nb_samples, const uint16_t sample_rate, const uint32_t f_cpu, const uint32_t budget, const double min_snr, const uint8_t formats, uint8_t * const osr, uint8_t * const format)
+{
+	uint32_t nb_excerpt;
+	int16_t * excerpt=auto_make_excerpt(data, nb_samples, sample_rate, &nb_excerpt);
+
+	double snr_pdm[256]; //plain and compressed are the same data
+	bool snr_pdm_known[256]={false};
+
+	bool found=false;
+	double best_rate=0, best_snr=0;
+
+	printf("Searching for at most %u bytes/s from the card and a SNR of at least %.1fdB (%s %us):\n", budget, min_snr, nb_excerpt==nb_samples?"whole file,":"excerpt of", nb_excerpt/sample_rate);
+
+	uint8_t f;
+	for(f=0; f<3; f++)
+	{
+		if(!(formats&(1<<f)))
+			continue;
+
+		double best_snr_format=-INFINITY;
+		uint8_t best_osr_format=0;
+		bool found_format=false;
+		uint16_t o;
+
+		for(o=1; o<=255; o++)
+		{
+			float ubbr_value_float;
+			uint16_t ubbr_value;
+			if(!calc_ubbr(f_cpu, sample_rate, o, &ubbr_value_float, &ubbr_value))
+				continue;
+			if(fabs((ubbr_value_float+1)/(ubbr_value+1)-1)>AUTO_MAX_RATE_ERROR)
+				continue;
+
+			//limits that don't depend on the content, higher OSR won't do either
+			if((uint64_t)2*o*nb_samples>UINT32_MAX-7)
+				break;
+			if((1<<f)==AUTO_PLAIN && (uint32_t)o*sample_rate/4>budget)
+				break;
+			if((1<<f)==AUTO_PCM8)
+			{
+				if(o%4)
+					continue;
+				if(sample_rate>budget || (uint64_t)2*o*sample_rate*AUTO_PCM8_CYCLES_PER_BIT>f_cpu)
+					break;
+			}
+
+			double snr;
+			if((1<<f)==AUTO_PCM8)
+				snr=auto_snr(excerpt, nb_excerpt, sample_rate, o, true);
+			else
+			{
+				if(!snr_pdm_known[o])
+				{
+					snr_pdm[o]=auto_snr(excerpt, nb_excerpt, sample_rate, o, false);
+					snr_pdm_known[o]=true;
+				}
+				snr=snr_pdm[o];
+			}
+
+			if(snr>best_snr_format)
+			{
+				best_snr_format=snr;
+				best_osr_format=o;
+			}
+
+			if(snr<min_snr)
+				continue;
+
+			double rate;
+			if((1<<f)==AUTO_COMPRESSED)
+			{
+				rate=auto_compressed_rate(data, nb_samples, sample_rate, o);
+				if(rate>budget)
+				{
+					printf("  %-10s OSR %u reaches %.1fdB but needs %.0f bytes/s at the worst place\n", auto_format_names[f], o, snr, rate);
+					break;
+				}
+			}
+			else if((1<<f)==AUTO_PLAIN)
+				rate=(double)o*sample_rate/4;
+			else
+				rate=sample_rate;
+
+			printf("  %-10s OSR %u: %.1fdB, %.0f bytes/s, UBBR %u (%+.2f%% rate)\n", auto_format_names[f], o, snr, rate, ubbr_value, 100*((ubbr_value_float+1)/(ubbr_value+1)-1));
+			found_format=true;
+
+			if(!found || rate<best_rate || (rate==best_rate && snr>best_snr))
+			{
+				found=true;
+				best_rate=rate;
+				best_snr=snr;
+				(*osr)=o;
+				(*format)=1<<f;
+			}
+
+			break; //higher OSR only costs more
+		}
+
+		if(!found_format)
+		{
+			if(best_osr_format)
+				printf("  %-10s nothing within budget reaches %.1fdB, best is %.1fdB with OSR %u\n", auto_format_names[f], min_snr, best_snr_format, best_osr_format);
+			else
+				printf("  %-10s nothing fits the budget\n", auto_format_names[f]);
+		}
+	}
+
+	free(excerpt);
+
+	printf("\n");
+
+	return found;
+}
+
+//--cache: outputs are kept in a directory under a hash of everything they depend on, an unchanged file is linked (or copied) from there instead of being converted again
+
+#define CACHE_VERSION 4 //4: entries are private copies, older ones may have been overwritten through a hardlink; increase whenever the output for the same input and options changes (modulator, header...)
+#define CACHE_COPY_BUFFER_SIZE 16384
+
+//FNV-1a 64 bit
+#define CACHE_FNV_OFFSET 0xcbf29ce484222325ULL
+#define CACHE_FNV_PRIME 0x100000001b3ULL
+
+static uint64_t cache_hash(uint64_t hash, void const * const data, const size_t nb_bytes)
+{
+	uint8_t const * d=data;
+	size_t i;
+	for(i=0; i<nb_bytes; i++)
+	{
+		hash^=d[i];
+		hash*=CACHE_FNV_PRIME;
+	}
+	return hash;
+}
+
+//hash of the parameters, the PCM-data (as s16le) must be hashed afterwards
+static uint64_t cache_key_start(const uint8_t osr, const uint8_t codec, const bool with_header, const uint32_t f_cpu, const uint16_t sample_rate, const uint32_t nb_samples, const uint32_t loop_start)
+{
+	uint8_t params[20];
+	params[0]=CACHE_VERSION;
+	params[1]=PDM_HEADER_VERSION;
+	params[2]=osr;
+	params[3]=codec;
+	params[4]=with_header;
+	params[5]=f_cpu; params[6]=f_cpu>>8; params[7]=f_cpu>>16; params[8]=f_cpu>>24;
+	params[9]=sample_rate; params[10]=sample_rate>>8;
+	params[11]=nb_samples; params[12]=nb_samples>>8; params[13]=nb_samples>>16; params[14]=nb_samples>>24;
+	params[15]=loop_start; params[16]=loop_start>>8; params[17]=loop_start>>16; params[18]=loop_start>>24;
+	params[19]=0;
+
+	uint64_t hash=cache_hash(CACHE_FNV_OFFSET, params, sizeof(params));
+
+	//compressed output also depends on the code tables
+	if(codec==PDM_HEADER_CODEC_HUFFMAN)
+	{
+		hash=cache_hash(hash, pdm_codec_table_of_context, sizeof(pdm_codec_table_of_context));
+		hash=cache_hash(hash, pdm_codec_length, sizeof(pdm_codec_length));
+	}
+
+	return hash;
+}
+
+static uint64_t cache_hash_pcm(uint64_t hash, int16_t const * const data, const uint32_t nb_samples)
+{
+	uint32_t i;
+	for(i=0; i<nb_samples; i++)
+	{
+		uint8_t s[2]={ (uint16_t)data[i]&0xFF, (uint16_t)data[i]>>8 };
+		hash=cache_hash(hash, s, 2);
+	}
+	return hash;
+}
+
+static void cache_path(char * const path, const size_t size, char const * const cache_dir, const uint64_t key)
+{
+	if((size_t)snprintf(path, size, "%s/%016llx.bin", cache_dir, (unsigned long long)key)>=size)
+		errx(1, "name of cache directory %s is too long", cache_dir);
+}
+
+//a reflink where the file system supports it (btrfs, XFS...), the copy shares the blocks but not the inode
+static bool copy_file(char const * const from, char const * const to_file_name, const int fd_to)
+{
+	int fd_from=open(from, O_RDONLY);
+	if(fd_from<0)
+		return false;
+
+	if(!ioctl(fd_to, FICLONE, fd_from))
+	{
+		close(fd_from);
+		return true;
+	}
+
+	uint8_t buffer[CACHE_COPY_BUFFER_SIZE];
+	size_t nb_read;
+	do
+	{
+		if(!read_all(fd_from, buffer, sizeof(buffer), &nb_read))
+			err(1, "reading %s failed", from);
+		if(write(fd_to, buffer, nb_read)!=(ssize_t)nb_read)
+			err(1, "writing %s failed", to_file_name);
+	} while(nb_read==sizeof(buffer));
+
+	close(fd_from);
+	return true;
+}
+
+//true if the output was taken from the cache, it is a copy so nothing done to the output can change the cache
+static bool cache_fetch(char const * const cache_dir, const uint64_t key, char const * const file_name)
+{
+	char path[PATH_MAX];
+	cache_path(path, sizeof(path), cache_dir, key);
+
+	if(access(path, R_OK))
+		return false;
+
+	int fd=open(file_name, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+	if(fd<0)
+		err(1, "creating output file %s failed", file_name);
+	if(!copy_file(path, file_name, fd))
+		err(1, "reading cache file %s failed", path);
+	if(close(fd))
+		err(1, "writing output file %s failed", file_name);
+	return true;
+}
+
+//adds a copy of a finished output to the cache, the entry appears atomically so concurrent runs are fine
+static void cache_store(char const * const cache_dir, const uint64_t key, char const * const file_name)
+{
+	char path[PATH_MAX];
+	cache_path(path, sizeof(path), cache_dir, key);
+
+	if(!access(path, F_OK))
+		return;
+
+	char tmp[PATH_MAX+8];
+	snprintf(tmp, sizeof(tmp), "%s.XXXXXX", path);
+	int fd=mkstemp(tmp);
+	if(fd<0)
+		err(1, "creating cache file in %s failed", cache_dir);
+	if(!copy_file(file_name, tmp, fd))
+		err(1, "reading %s failed", file_name);
+	if(fchmod(fd, 0644) || close(fd) || rename(tmp, path))
+		err(1, "writing cache file %s failed", path);
+}
+
+//output of the single file mode: two aligned buffers, one is filled while a thread writes the other so modulation and disk run at the same time
+#define WRITER_BUFFER_SIZE (1<<20) //bytes per buffer, a multiple of WRITER_ALIGNMENT
+#define WRITER_ALIGNMENT 4096 //O_DIRECT needs aligned memory, sizes and offsets, 4096 works for every device
+
+typedef struct
+{
+	int fd;
+	char const * name;
+	bool own_fd; //opened by writer_open()
+	bool direct; //O_DIRECT
+	bool seekable;
+	uint8_t * buffers[2];
+	uint8_t current; //buffer being filled
+	uint32_t fill;
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	uint8_t pending; //buffer being written
+	uint32_t nb_pending; //bytes of buffers[pending] still to write, 0 if none
+	bool quit;
+} writer_t;
+
+static void write_all(const int fd, void const * const data, const size_t nb_bytes, char const * const name)
+{
+	size_t nb_written=0;
+	while(nb_written<nb_bytes)
+	{
+		ssize_t n=write(fd, (uint8_t const *)data+nb_written, nb_bytes-nb_written);
+		if(n<0 && errno==EINTR)
+			continue;
+		if(n<=0)
+			err(1, "writing output file %s failed", name);
+		nb_written+=n;
+	}
+}
+
+static void * writer_thread(void * arg)
+{
+	writer_t * const writer=arg;
+
+	pthread_mutex_lock(&writer->lock);
+	while(1)
+	{
+		while(!writer->nb_pending && !writer->quit)
+			pthread_cond_wait(&writer->cond, &writer->lock);
+		if(!writer->nb_pending)
+			break;
+
+		uint8_t const * buffer=writer->buffers[writer->pending];
+		uint32_t nb=writer->nb_pending;
+		pthread_mutex_unlock(&writer->lock);
+		write_all(writer->fd, buffer, nb, writer->name);
+		pthread_mutex_lock(&writer->lock);
+
+		writer->nb_pending=0;
+		pthread_cond_broadcast(&writer->cond);
+	}
+	pthread_mutex_unlock(&writer->lock);
+
+	return NULL;
+}
+
+//fd>=0 is used as it is (stdout), else file_name is created
+static void writer_open(writer_t * const writer, char const * const file_name, const int fd, const bool direct)
+{
+	writer->name=file_name;
+	writer->own_fd=(fd<0);
+	writer->direct=direct;
+	if(writer->own_fd)
+		prepare_output(file_name);
+	writer->fd=writer->own_fd?open(file_name, O_WRONLY|O_CREAT|O_TRUNC|(direct?O_DIRECT:0), 0644):fd;
+	if(writer->fd<0 && direct && errno==EINVAL)
+		errx(1, "%s doesn't support --direct", file_name);
+	if(writer->fd<0)
+		err(1, "creating output file %s failed", file_name);
+	writer->seekable=(lseek(writer->fd, 0, SEEK_CUR)>=0);
+
+	uint8_t i;
+	for(i=0; i<2; i++)
+		if(posix_memalign((void**)&writer->buffers[i], WRITER_ALIGNMENT, WRITER_BUFFER_SIZE))
+			errx(1, "malloc for output buffers failed");
+	writer->current=0;
+	writer->fill=0;
+	writer->nb_pending=0;
+	writer->quit=false;
+	pthread_mutex_init(&writer->lock, NULL);
+	pthread_cond_init(&writer->cond, NULL);
+	if(pthread_create(&writer->thread, NULL, writer_thread, writer))
+		errx(1, "creating thread failed");
+}
+
+//hands the current buffer to the thread once it is done with the other one
+static void writer_submit(writer_t * const writer)
+{
+	pthread_mutex_lock(&writer->lock);
+	while(writer->nb_pending)
+		pthread_cond_wait(&writer->cond, &writer->lock);
+	writer->pending=writer->current;
+	writer->nb_pending=writer->fill;
+	pthread_cond_broadcast(&writer->cond);
+	pthread_mutex_unlock(&writer->lock);
+
+	writer->current^=1;
+	writer->fill=0;
+}
+
+static void writer_write(writer_t * const writer, void const * const data, const uint32_t nb_bytes)
+{
+	uint32_t i=0;
+	while(i<nb_bytes)
+	{
+		uint32_t nb=WRITER_BUFFER_SIZE-writer->fill;
+		if(nb>nb_bytes-i)
+			nb=nb_bytes-i;
+		memcpy(&writer->buffers[writer->current][writer->fill], (uint8_t const *)data+i, nb);
+		writer->fill+=nb;
+		i+=nb;
+
+		if(writer->fill==WRITER_BUFFER_SIZE)
+			writer_submit(writer);
+	}
+}
+
+//writes what is left and stops the thread
+static void writer_finish(writer_t * const writer)
+{
+	pthread_mutex_lock(&writer->lock);
+	while(writer->nb_pending)
+		pthread_cond_wait(&writer->cond, &writer->lock);
+	writer->quit=true;
+	pthread_cond_broadcast(&writer->cond);
+	pthread_mutex_unlock(&writer->lock);
+	pthread_join(writer->thread, NULL);
+
+	//O_DIRECT can't write the unaligned end
+	uint32_t nb_aligned=writer->direct?writer->fill/WRITER_ALIGNMENT*WRITER_ALIGNMENT:writer->fill;
+	write_all(writer->fd, writer->buffers[writer->current], nb_aligned, writer->name);
+	if(nb_aligned<writer->fill)
+	{
+		if(fcntl(writer->fd, F_SETFL, fcntl(writer->fd, F_GETFL)&~O_DIRECT))
+			err(1, "writing output file %s failed", writer->name);
+		writer->direct=false;
+		write_all(writer->fd, &writer->buffers[writer->current][nb_aligned], writer->fill-nb_aligned, writer->name);
+	}
+	writer->fill=0;
+}
+
+//overwrites already written data, only after writer_finish()
+static void writer_patch(writer_t * const writer, void const * const data, const uint32_t nb_bytes, const off_t offset)
+{
+	if(writer->direct)
+	{
+		if(fcntl(writer->fd, F_SETFL, fcntl(writer->fd, F_GETFL)&~O_DIRECT))
+			err(1, "writing output file %s failed", writer->name);
+		writer->direct=false;
+	}
+	if(pwrite(writer->fd, data, nb_bytes, offset)!=(ssize_t)nb_bytes)
+		err(1, "writing output file %s failed", writer->name);
+}
+
+static void writer_close(writer_t * const writer)
+{
+	if(writer->own_fd && close(writer->fd))
+		err(1, "writing output file %s failed", writer->name);
+	pthread_mutex_destroy(&writer->lock);
+	pthread_cond_destroy(&writer->cond);
+	free(writer->buffers[0]);
+	free(writer->buffers[1]);
+}
+
+//converts PCM block by block so pdmconv can sit in a pipe (--raw-in) and needs little memory (--batch, single file mode)
+#define STREAM_BLOCK_SIZE 1024 //bytes read at once at most, 32ms at 16kHz
+
+typedef struct
+{
+	FILE * out; //output goes to out or writer, with both NULL it is only counted
+	writer_t * writer;
+	bool compressed;
+	uint8_t block[PDM_CODEC_BLOCK_SIZE]; //for --compress, packed PDM-data waiting for a full block
+	uint16_t nb_block;
+	uint64_t nb_bytes; //written
+	uint64_t nb_bytes_pdm; //before compression
+	uint32_t nb_blocks; //compressed
+	uint32_t nb_blocks_stored;
+	uint32_t max_two_blocks; //biggest size of 2 consecutive blocks
+	uint16_t previous_size;
+} stream_t;
+
+static void stream_init(stream_t * const stream, FILE * const out, writer_t * const writer, const bool compressed)
+{
+	memset(stream, 0, sizeof(stream_t));
+	stream->out=out;
+	stream->writer=writer;
+	stream->compressed=compressed;
+}
+
+static void stream_write(stream_t * const stream, void const * const data, const uint32_t nb_bytes)
+{
+	if(stream->writer)
+		writer_write(stream->writer, data, nb_bytes);
+	else if(stream->out && fwrite(data, sizeof(uint8_t), nb_bytes, stream->out)!=nb_bytes)
+		err(1, "writing output failed");
+	stream->nb_bytes+=nb_bytes;
+}
+
+static void stream_write_block(stream_t * const stream)
+{
+	uint8_t block_compressed[2+PDM_CODEC_BLOCK_SIZE];
+	uint16_t size=codec_encode_block(stream->block, block_compressed);
+	stream_write(stream, block_compressed, size);
+	stream->nb_block=0;
+
+	stream->nb_blocks++;
+	if(size==2+PDM_CODEC_BLOCK_SIZE)
+		stream->nb_blocks_stored++;
+	if(stream->previous_size+size>stream->max_two_blocks)
+		stream->max_two_blocks=stream->previous_size+size;
+	stream->previous_size=size;
+}
+
+static void stream_write_pdm(stream_t * const stream, uint8_t const * const data, const uint32_t nb_bytes)
+{
+	stream->nb_bytes_pdm+=nb_bytes;
+
+	if(!stream->compressed)
+	{
+		stream_write(stream, data, nb_bytes);
+		return;
+	}
+
+	uint32_t i=0;
+	while(i<nb_bytes)
+	{
+		uint32_t nb=PDM_CODEC_BLOCK_SIZE-stream->nb_block;
+		if(nb>nb_bytes-i)
+			nb=nb_bytes-i;
+		memcpy(&stream->block[stream->nb_block], &data[i], nb);
+		stream->nb_block+=nb;
+		i+=nb;
+
+		if(stream->nb_block==PDM_CODEC_BLOCK_SIZE)
+			stream_write_block(stream);
+	}
+}
+
+//completes the output like the single file mode does, enc is NULL for PCM8
+//pad_plain pads plain PDM-data to full sectors with the idle pattern of the modulator (files with header)
+static void stream_end(stream_t * const stream, pdmenc_t * const enc, const bool pad_plain)
+{
+	uint8_t buffer[PDMENC_BUFFER_SIZE];
+
+	if(!enc)
+	{
+		//PCM8 is padded with silence
+		memset(buffer, 0, 512);
+		stream_write(stream, buffer, (512-stream->nb_bytes%512)%512);
+		return;
+	}
+
+	pdmenc_flush(enc);
+	stream_write_pdm(stream, buffer, pdmenc_pull_packed(enc, buffer, sizeof(buffer)));
+
+	if(stream->compressed)
+	{
+		//last block is padded with the idle pattern of the modulator, stream ends with PDM_CODEC_END and is padded to full sectors
+		if(stream->nb_block)
+		{
+			memset(&stream->block[stream->nb_block], 0xAA, PDM_CODEC_BLOCK_SIZE-stream->nb_block);
+			stream_write_block(stream);
+		}
+		uint8_t end[2]={ PDM_CODEC_END&0xFF, PDM_CODEC_END>>8 };
+		stream_write(stream, end, 2);
+		memset(buffer, 0, 512);
+		stream_write(stream, buffer, (512-stream->nb_bytes%512)%512);
+	}
+	else if(pad_plain)
+	{
+		memset(buffer, 0xAA, 512);
+		stream_write(stream, buffer, (512-stream->nb_bytes%512)%512);
+	}
+}
+
+//--loop: the input from sample start to its end repeats forever, the firmware goes back to the loop start at a sector boundary
+//so the part before the loop and the loop must be whole sectors of output (PDM-data before compression for --compress, 512 samples for PCM8)
+#define LOOP_NONE UINT32_MAX
+#define LOOP_MAX_COPIES 16 //the loop is repeated until it ends at a sector boundary, more copies make the file too big
+#define LOOP_PREROLL 1024 //samples at the end of the loop modulated (and thrown away) before it, a multiple of 4 to keep the output in whole bytes
+
+typedef struct
+{
+	uint32_t start; //sample of the input, LOOP_NONE for no loop
+	uint32_t nb_silence; //before the input so the loop starts at a sector boundary
+	uint32_t nb_copies; //of the loop so it ends at a sector boundary
+	uint32_t nb_samples; //in the output, silence and copies included
+	uint32_t start_sector; //of the data as in the header, only known after convert_mapped() for --compress
+	uint32_t end_sector;
+} loop_t;
+
+//returns NULL if fine or what is wrong
+static char const * loop_init(loop_t * const loop, const uint32_t start, const uint32_t nb_samples, const uint8_t oversampling_ratio, const bool output_pcm8)
+{
+	memset(loop, 0, sizeof(loop_t));
+	loop->start=start;
+
+	if(start>=nb_samples)
+		return "the loop must start before the end of the input";
+
+	//a sector holds 4096 bits and a sample 2*OSR of them, so the loop can only start and end every granularity samples (a power of 2)
+	uint32_t nb_bits=2*oversampling_ratio;
+	uint32_t granularity=output_pcm8?512:4096/(((nb_bits&-nb_bits)<4096)?(nb_bits&-nb_bits):4096);
+	uint32_t length=nb_samples-start;
+	uint32_t length_factor=((length&-length)<granularity)?(length&-length):granularity;
+
+	loop->nb_silence=(granularity-start%granularity)%granularity;
+	loop->nb_copies=granularity/length_factor;
+	if(loop->nb_copies>LOOP_MAX_COPIES)
+	{
+		static char error[128];
+		snprintf(error, sizeof(error), "the loop is %u samples, with this OSR and format its length must be a multiple of %u samples", length, granularity/LOOP_MAX_COPIES);
+		return error;
+	}
+
+	uint64_t nb_out=(uint64_t)loop->nb_silence+start+(uint64_t)loop->nb_copies*length;
+	if(nb_out*nb_bits>UINT32_MAX-7)
+		return "the looped output is too long for this OSR";
+	loop->nb_samples=nb_out;
+
+	//exact, the part before the loop and the loop are multiples of granularity
+	uint32_t nb_before=loop->nb_silence+start;
+	loop->start_sector=output_pcm8?nb_before/512:(uint64_t)nb_before*nb_bits/4096;
+	loop->end_sector=output_pcm8?loop->nb_samples/512:(uint64_t)loop->nb_samples*nb_bits/4096;
+
+	return NULL;
+}
+
+//modulates nb_samples of data (NULL is silence), or converts them to PCM8 if enc is NULL, with stream NULL the output is thrown away
+static void convert_part(stream_t * const stream, pdmenc_t * const enc, int16_t const * const data, const uint32_t nb_samples)
+{
+	static const int16_t silence[STREAM_BLOCK_SIZE];
+	int8_t samples_pcm[STREAM_BLOCK_SIZE];
+	uint8_t packed[PDMENC_BUFFER_SIZE];
+
+	uint32_t index_in=0;
+	while(index_in<nb_samples)
+	{
+		uint32_t nb=nb_samples-index_in;
+		if((!data || !enc) && nb>STREAM_BLOCK_SIZE)
+			nb=STREAM_BLOCK_SIZE;
+		int16_t const * const in=data?&data[index_in]:silence;
+
+		if(!enc)
+		{
+			convert_pcm8(in, nb, samples_pcm);
+			if(stream)
+				stream_write(stream, samples_pcm, nb);
+			index_in+=nb;
+		}
+		else
+		{
+			index_in+=pdmenc_push_pcm(enc, in, nb);
+			uint32_t nb_packed=pdmenc_pull_packed(enc, packed, sizeof(packed));
+			if(stream)
+				stream_write_pdm(stream, packed, nb_packed);
+		}
+	}
+}
+
+//the whole input is in memory (mapped), writer can be NULL to only count
+//loop is NULL or from loop_init(), its sectors are set here
+//codec_build_codes() must have been called for output_compressed
+static void convert_mapped(int16_t const * const data, const uint32_t nb_samples, writer_t * const writer, const uint8_t oversampling_ratio, const bool output_pcm8, const bool output_compressed, const bool pad_plain, loop_t * const loop, stream_t * const stream)
+{
+	stream_init(stream, NULL, writer, output_compressed);
+
+	pdmenc_t enc;
+	pdmenc_t * const e=output_pcm8?NULL:&enc;
+	if(e && !pdmenc_init(e, oversampling_ratio))
+		errx(1, "invalid OSR %u", oversampling_ratio);
+
+	if(!loop)
+	{
+		convert_part(stream, e, data, nb_samples);
+		stream_end(stream, e, pad_plain);
+		return;
+	}
+
+	//the part before the loop ends at a sector boundary, so stream_end() only adds PDM_CODEC_END and its padding for --compress
+	convert_part(stream, e, NULL, loop->nb_silence);
+	convert_part(stream, e, data, loop->start);
+	if(stream->nb_bytes)
+		stream_end(stream, e, pad_plain);
+	loop->start_sector=stream->nb_bytes/512;
+
+	//the modulator enters the loop in the state it has at the end of the loop, so the PDM-data is continuous when the firmware goes back
+	uint32_t length=nb_samples-loop->start;
+	if(e)
+	{
+		uint32_t nb_preroll=((length<LOOP_PREROLL)?length:LOOP_PREROLL)&~3u;
+		convert_part(NULL, e, &data[nb_samples-nb_preroll], nb_preroll);
+	}
+
+	uint32_t i;
+	for(i=0; i<loop->nb_copies; i++)
+		convert_part(stream, e, &data[loop->start], length);
+	stream_end(stream, e, pad_plain);
+	loop->end_sector=stream->nb_bytes/512;
+}
+
+//reads at most nb_bytes_in, flush_blocks makes every block go out immediately
+//codec_build_codes() must have been called for output_compressed
+static void convert_stream(const int fd_in, const uint64_t nb_bytes_in, FILE * const out, const uint8_t oversampling_ratio, const bool output_pcm8, const bool output_compressed, const bool flush_blocks, uint64_t * const nb_samples_total, uint64_t * const nb_bytes_pdm, uint64_t * const nb_bytes_written)
+{
+	uint8_t in[STREAM_BLOCK_SIZE];
+	uint16_t nb_in=0; //an odd byte can be left from the previous read
+	int16_t samples[STREAM_BLOCK_SIZE/2];
+	int8_t samples_pcm[STREAM_BLOCK_SIZE/2];
+	uint8_t packed[PDMENC_BUFFER_SIZE];
+	uint64_t nb_bytes_left=nb_bytes_in;
+
+	stream_t stream;
+	stream_init(&stream, out, NULL, output_compressed);
+	(*nb_samples_total)=0;
+
+	pdmenc_t enc;
+	if(!pdmenc_init(&enc, oversampling_ratio))
+		errx(1, "invalid OSR %u", oversampling_ratio);
+
+	while(nb_bytes_left)
+	{
+		size_t nb_read=STREAM_BLOCK_SIZE-nb_in;
+		if(nb_read>nb_bytes_left)
+			nb_read=nb_bytes_left;
+		ssize_t n=read(fd_in, &in[nb_in], nb_read);
+		if(n<0 && errno==EINTR)
+			continue;
+		if(n<0)
+			err(1, "reading input failed");
+		if(n==0)
+			break;
+		nb_in+=n;
+		nb_bytes_left-=n;
+
+		//s16le whatever the byte order of this machine is
+		uint16_t nb_samples=nb_in/2;
+		uint16_t i;
+		for(i=0; i<nb_samples; i++)
+			samples[i]=(int16_t)(in[2*i]|(in[2*i+1]<<8));
+		if(nb_in&1)
+			in[0]=in[nb_in-1];
+		nb_in&=1;
+		(*nb_samples_total)+=nb_samples;
+
+		if(output_pcm8)
+		{
+			convert_pcm8(samples, nb_samples, samples_pcm);
+			stream_write(&stream, samples_pcm, nb_samples);
+		}
+		else
+		{
+			uint16_t index_in=0;
+			while(index_in<nb_samples)
+			{
+				index_in+=pdmenc_push_pcm(&enc, &samples[index_in], nb_samples-index_in);
+				stream_write_pdm(&stream, packed, pdmenc_pull_packed(&enc, packed, sizeof(packed)));
+			}
+		}
+
+		if(flush_blocks && fflush(out))
+			err(1, "writing output failed");
+	}
+
+	if(nb_in)
+		warnx("odd number of bytes in input, last byte ignored");
+
+	//same end as the files made with --no-header
+	stream_end(&stream, output_pcm8?NULL:&enc, false);
+
+	if(flush_blocks && fflush(out))
+		err(1, "writing output failed");
+
+	(*nb_bytes_pdm)=stream.nb_bytes_pdm;
+	(*nb_bytes_written)=stream.nb_bytes;
+}
+
+//writes the output for mapped input to file_name (or fd if not -1) through a writer, with header if with_header
+//loop is NULL or from loop_init()
+//codec_build_codes() must have been called for output_compressed
+static void write_output(int16_t const * const data, const uint32_t nb_samples, const uint16_t sample_rate, char const * const file_name, const int fd, const bool direct, const uint8_t oversampling_ratio, const bool output_pcm8, const bool output_compressed, const bool with_header, const uint32_t f_cpu, const uint16_t ubbr_value, loop_t * const loop, stream_t * const stream)
+{
+	uint8_t codec=output_pcm8?PDM_HEADER_CODEC_PCM8:(output_compressed?PDM_HEADER_CODEC_HUFFMAN:PDM_HEADER_CODEC_NONE);
+	uint32_t nb_samples_output=loop?loop->nb_samples:nb_samples;
+	uint32_t nb_bytes_output=(2*oversampling_ratio*nb_samples_output+7)/8;
+
+	writer_t writer;
+	writer_open(&writer, file_name, fd, direct);
+
+	//the number of sectors of compressed data is only known at the end: the header is written again then or, if that's impossible (pipe), the data is compressed twice
+	uint8_t header[512];
+	if(with_header)
+	{
+		uint32_t nb_sectors=0;
+		if(output_pcm8)
+			nb_sectors=(nb_samples_output+511)/512;
+		else if(!output_compressed)
+			nb_sectors=(nb_bytes_output+511)/512;
+		else if(!writer.seekable)
+		{
+			convert_mapped(data, nb_samples, NULL, oversampling_ratio, output_pcm8, output_compressed, with_header, loop, stream);
+			nb_sectors=stream->nb_bytes/512;
+		}
+		make_header(header, codec, oversampling_ratio, sample_rate, ubbr_value, f_cpu, output_pcm8?nb_samples_output:nb_bytes_output, nb_sectors, loop?loop->start_sector:0, loop?loop->end_sector:0);
+		writer_write(&writer, header, 512);
+	}
+
+	convert_mapped(data, nb_samples, &writer, oversampling_ratio, output_pcm8, output_compressed, with_header, loop, stream);
+
+	writer_finish(&writer);
+
+	if(with_header && output_compressed && writer.seekable)
+	{
+		make_header(header, codec, oversampling_ratio, sample_rate, ubbr_value, f_cpu, nb_bytes_output, stream->nb_bytes/512, loop?loop->start_sector:0, loop?loop->end_sector:0);
+		writer_patch(&writer, header, 512, 0);
+	}
+
+	writer_close(&writer);
+}
+
+//--batch: converts all wave files of a directory with one worker thread per core
+//every worker has its own queue of files, biggest first, and steals the smallest files of the others when its queue is empty
+//a worker only needs the buffers of convert_stream() (about 12kB) whatever the size of the files
+
+#define BATCH_MAX_WORKERS 64
+
+typedef struct
+{
+	char * name;
+	off_t size;
+} batch_file_t;
+
+typedef struct
+{
+	pthread_mutex_t lock;
+	uint32_t * files; //indices into batch_t.files
+	uint32_t head; //taken by the owner
+	uint32_t tail; //stolen by the others
+} batch_queue_t;
+
+typedef struct
+{
+	char const * in_dir;
+	char const * out_dir;
+	batch_file_t * files; //biggest first
+	uint32_t nb_files;
+
+	uint8_t oversampling_ratio;
+	bool output_pcm8;
+	bool output_compressed;
+	bool with_header;
+	uint32_t f_cpu;
+	char const * cache_dir; //NULL if not used
+
+	uint32_t nb_workers;
+	batch_queue_t queues[BATCH_MAX_WORKERS];
+
+	pthread_mutex_t report_lock; //for the report and the totals
+	uint64_t nb_samples;
+	uint64_t nb_bytes;
+	uint32_t nb_failed;
+	uint32_t nb_cached;
+} batch_t;
+
+typedef struct
+{
+	batch_t * batch;
+	uint32_t index;
+} batch_worker_t;
+
+static double batch_time(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec+t.tv_nsec/1E9;
+}
+
+static bool batch_is_wav(char const * const name)
+{
+	size_t len=strlen(name);
+	return len>4 && !strcasecmp(&name[len-4], ".wav");
+}
+
+//next file for a worker, false if there is nothing left anywhere
+static bool batch_next_file(batch_t * const batch, const uint32_t worker, uint32_t * const file)
+{
+	uint32_t i;
+	for(i=0; i<batch->nb_workers; i++)
+	{
+		batch_queue_t * queue=&batch->queues[(worker+i)%batch->nb_workers];
+		bool found=false;
+		pthread_mutex_lock(&queue->lock);
+		if(queue->head<queue->tail)
+		{
+			found=true;
+			if(i==0)
+				(*file)=queue->files[queue->head++];
+			else
+				(*file)=queue->files[--queue->tail];
+		}
+		pthread_mutex_unlock(&queue->lock);
+		if(found)
+			return true;
+	}
+
+	return false;
+}
+
+//hashes the audio-data and goes back to its start
+static char const * batch_cache_key(batch_t const * const batch, const int fd_in, const uint8_t codec, const uint16_t sample_rate, const uint32_t nb_samples, uint64_t * const key)
+{
+	uint64_t hash=cache_key_start(batch->oversampling_ratio, codec, batch->with_header, batch->f_cpu, sample_rate, nb_samples, LOOP_NONE);
+
+	off_t start=lseek(fd_in, 0, SEEK_CUR);
+	uint64_t nb_left=(uint64_t)nb_samples*sizeof(int16_t);
+	while(nb_left)
+	{
+		uint8_t block[CACHE_COPY_BUFFER_SIZE];
+		size_t nb=(nb_left<sizeof(block))?nb_left:sizeof(block);
+		size_t nb_read;
+		if(!read_all(fd_in, block, nb, &nb_read) || nb_read!=nb)
+			return "reading audio data failed";
+		hash=cache_hash(hash, block, nb); //wave files are s16le already
+		nb_left-=nb;
+	}
+
+	if(start<0 || lseek(fd_in, start, SEEK_SET)!=start)
+		return "reading audio data failed";
+
+	(*key)=hash;
+	return NULL;
+}
+
+//output name is the input name with .bin instead of .wav, returns NULL if fine or what is wrong
+static char const * batch_convert_file(batch_t * const batch, char const * const file_name, uint64_t * const nb_samples, uint64_t * const nb_bytes, bool * const cached)
+{
+	size_t len=strlen(file_name);
+	char * in_path=malloc(strlen(batch->in_dir)+len+2);
+	char * out_path=malloc(strlen(batch->out_dir)+len+2);
+	if(!in_path || !out_path)
+		err(1, "malloc for file names failed");
+	sprintf(in_path, "%s/%s", batch->in_dir, file_name);
+	sprintf(out_path, "%s/%.*s.bin", batch->out_dir, (int)(len-4), file_name);
+
+	char const * error=NULL;
+	int fd_in=open(in_path, O_RDONLY);
+	FILE * out=NULL;
+	uint32_t nb_samples_wav;
+	uint16_t sample_rate;
+	float ubbr_value_float;
+	uint16_t ubbr_value;
+	uint8_t codec=batch->output_pcm8?PDM_HEADER_CODEC_PCM8:(batch->output_compressed?PDM_HEADER_CODEC_HUFFMAN:PDM_HEADER_CODEC_NONE);
+	uint64_t cache_key=0;
+
+	(*cached)=false;
+
+	if(fd_in<0)
+		error="opening failed";
+	else if((error=read_wav_header(fd_in, &nb_samples_wav, &sample_rate)))
+		;
+	else if((uint64_t)2*batch->oversampling_ratio*nb_samples_wav>UINT32_MAX-7)
+		error="too long for this OSR";
+	else if(!calc_ubbr(batch->f_cpu, sample_rate, batch->oversampling_ratio, &ubbr_value_float, &ubbr_value))
+		error="this OSR can't be done with this clock at this sample rate";
+	else if(!prepare_output(out_path) && batch->cache_dir)
+		error="output is not a regular file, can't use the cache";
+	else if(batch->cache_dir && (error=batch_cache_key(batch, fd_in, codec, sample_rate, nb_samples_wav, &cache_key)))
+		;
+	else if(batch->cache_dir && cache_fetch(batch->cache_dir, cache_key, out_path))
+	{
+		struct stat st;
+		if(stat(out_path, &st))
+			err(1, "reading output file %s failed", out_path);
+		(*cached)=true;
+		(*nb_samples)=nb_samples_wav;
+		(*nb_bytes)=st.st_size;
+	}
+	else if(!(out=fopen(out_path, "wb")))
+		error="creating output file failed";
+	else
+	{
+		uint8_t sector[512];
+
+		//the sizes are only known at the end, the header is written last
+		if(batch->with_header)
+		{
+			memset(sector, 0, 512);
+			if(fwrite(sector, sizeof(uint8_t), 512, out)!=512)
+				err(1, "writing output file %s failed", out_path);
+		}
+
+		uint64_t nb_bytes_pdm;
+		convert_stream(fd_in, (uint64_t)nb_samples_wav*sizeof(int16_t), out, batch->oversampling_ratio, batch->output_pcm8, batch->output_compressed, false, nb_samples, &nb_bytes_pdm, nb_bytes);
+
+		if(batch->with_header)
+		{
+			//pad the last sector with the idle pattern of the modulator
+			if(codec==PDM_HEADER_CODEC_NONE)
+			{
+				memset(sector, 0xAA, 512);
+				uint16_t nb_pad=(512-(*nb_bytes)%512)%512;
+				if(fwrite(sector, sizeof(uint8_t), nb_pad, out)!=nb_pad)
+					err(1, "writing output file %s failed", out_path);
+				(*nb_bytes)+=nb_pad;
+			}
+
+			if(fseek(out, 0, SEEK_SET))
+				err(1, "writing output file %s failed", out_path);
+			write_header(out, codec, batch->oversampling_ratio, sample_rate, ubbr_value, batch->f_cpu, (codec==PDM_HEADER_CODEC_PCM8)?(*nb_samples):nb_bytes_pdm, (*nb_bytes)/512);
+			(*nb_bytes)+=512;
+		}
+
+		if(fclose(out))
+			err(1, "writing output file %s failed", out_path);
+
+		if(batch->cache_dir)
+			cache_store(batch->cache_dir, cache_key, out_path);
+	}
+
+	if(fd_in>=0)
+		close(fd_in);
+	free(in_path);
+	free(out_path);
+
+	return error;
+}
+
+static void * batch_worker(void * arg)
+{
+	batch_worker_t * const worker=arg;
+	batch_t * const batch=worker->batch;
+
+	uint32_t file;
+	while(batch_next_file(batch, worker->index, &file))
+	{
+		uint64_t nb_samples=0, nb_bytes=0;
+		bool cached;
+		double start=batch_time();
+		char const * error=batch_convert_file(batch, batch->files[file].name, &nb_samples, &nb_bytes, &cached);
+		double duration=batch_time()-start;
+
+		pthread_mutex_lock(&batch->report_lock);
+		if(error)
+		{
+			printf("  %s: %s, skipped\n", batch->files[file].name, error);
+			batch->nb_failed++;
+		}
+		else
+		{
+			printf("  %s: %llu samples in %.3fs, %.0f samples/s, %llu bytes%s\n", batch->files[file].name, (unsigned long long)nb_samples, duration, nb_samples/duration, (unsigned long long)nb_bytes, cached?" from cache":"");
+			batch->nb_samples+=nb_samples;
+			batch->nb_cached+=cached;
+			batch->nb_bytes+=nb_bytes;
+		}
+		fflush(stdout);
+		pthread_mutex_unlock(&batch->report_lock);
+	}
+
+	return NULL;
+}
+
+static int batch_compare_sizes(void const * a, void const * b)
+{
+	off_t sa=((batch_file_t const *)a)->size;
+	off_t sb=((batch_file_t const *)b)->size;
+	return (sa<sb)-(sa>sb);
+}
+
+static int convert_batch(char const * const in_dir, char const * const out_dir, const uint8_t oversampling_ratio, const bool output_pcm8, const bool output_compressed, const bool with_header, const uint32_t f_cpu, char const * const cache_dir)
+{
+	batch_t * b=calloc(1, sizeof(batch_t));
+	if(!b)
+		err(1, "malloc for batch failed");
+	b->in_dir=in_dir;
+	b->out_dir=out_dir;
+	b->oversampling_ratio=oversampling_ratio;
+	b->output_pcm8=output_pcm8;
+	b->output_compressed=output_compressed;
+	b->with_header=with_header;
+	b->f_cpu=f_cpu;
+	b->cache_dir=cache_dir;
+
+	DIR * dir=opendir(in_dir);
+	if(!dir)
+		err(1, "opening directory %s failed", in_dir);
+
+	uint32_t nb_allocated=0;
+	struct dirent * entry;
+	while((entry=readdir(dir)))
+	{
+		if(!batch_is_wav(entry->d_name))
+			continue;
+
+		char * path=malloc(strlen(in_dir)+strlen(entry->d_name)+2);
+		if(!path)
+			err(1, "malloc for file names failed");
+		sprintf(path, "%s/%s", in_dir, entry->d_name);
+		struct stat st;
+		bool regular=(!stat(path, &st) && S_ISREG(st.st_mode));
+		free(path);
+		if(!regular)
+			continue;
+
+		if(b->nb_files==nb_allocated)
+		{
+			nb_allocated=nb_allocated?2*nb_allocated:64;
+			b->files=realloc(b->files, nb_allocated*sizeof(batch_file_t));
+			if(!b->files)
+				err(1, "malloc for file list failed");
+		}
+		b->files[b->nb_files].name=strdup(entry->d_name);
+		if(!b->files[b->nb_files].name)
+			err(1, "malloc for file names failed");
+		b->files[b->nb_files].size=st.st_size;
+		b->nb_files++;
+	}
+	closedir(dir);
+
+	if(b->nb_files==0)
+		errx(1, "no wave files in %s", in_dir);
+
+	long nb_cores=sysconf(_SC_NPROCESSORS_ONLN);
+	b->nb_workers=(nb_cores<1)?1:((nb_cores>BATCH_MAX_WORKERS)?BATCH_MAX_WORKERS:nb_cores);
+	if(b->nb_workers>b->nb_files)
+		b->nb_workers=b->nb_files;
+
+	//biggest first, dealt out in turn so every queue gets about the same amount of work
+	qsort(b->files, b->nb_files, sizeof(batch_file_t), batch_compare_sizes);
+
+	uint32_t i;
+	for(i=0; i<b->nb_workers; i++)
+	{
+		b->queues[i].files=malloc((b->nb_files/b->nb_workers+1)*sizeof(uint32_t));
+		if(!b->queues[i].files)
+			err(1, "malloc for file list failed");
+		pthread_mutex_init(&b->queues[i].lock, NULL);
+	}
+	for(i=0; i<b->nb_files; i++)
+	{
+		batch_queue_t * queue=&b->queues[i%b->nb_workers];
+		queue->files[queue->tail++]=i;
+	}
+	pthread_mutex_init(&b->report_lock, NULL);
+
+	printf("Converting %u wave files from %s to %s with %u threads:\n", b->nb_files, in_dir, out_dir, b->nb_workers);
+
+	if(output_compressed)
+		codec_build_codes();
+
+	double start=batch_time();
+
+	pthread_t threads[BATCH_MAX_WORKERS];
+	batch_worker_t workers[BATCH_MAX_WORKERS];
+	for(i=0; i<b->nb_workers; i++)
+	{
+		workers[i].batch=b;
+		workers[i].index=i;
+		if(pthread_create(&threads[i], NULL, batch_worker, &workers[i]))
+			errx(1, "creating thread failed");
+	}
+	for(i=0; i<b->nb_workers; i++)
+		pthread_join(threads[i], NULL);
+
+	double duration=batch_time()-start;
+
+	printf("\n%u of %u files converted (%u from cache), %llu samples in %.3fs: %.0f samples/s, %llu bytes written.\n\n", b->nb_files-b->nb_failed, b->nb_files, b->nb_cached, (unsigned long long)b->nb_samples, duration, b->nb_samples/duration, (unsigned long long)b->nb_bytes);
+
+	int ret=b->nb_failed?1:0;
+
+	for(i=0; i<b->nb_workers; i++)
+	{
+		pthread_mutex_destroy(&b->queues[i].lock);
+		free(b->queues[i].files);
+	}
+	pthread_mutex_destroy(&b->report_lock);
+	for(i=0; i<b->nb_files; i++)
+		free(b->files[i].name);
+	free(b->files);
+	free(b);
+
+	return ret;
+}
+
+//--osr with a list: the wave file is mapped once and every OSR gets its own thread, modulator and output file
+//the threads read the same mapped audio, so this takes about as long as the slowest OSR alone if there are enough cores
+
+#define MULTI_MAX_OSR 16
+
+typedef struct
+{
+	int16_t const * data;
+	uint32_t nb_samples;
+	uint16_t sample_rate;
+	uint8_t oversampling_ratio;
+	bool output_pcm8;
+	bool output_compressed;
+	bool with_header;
+	bool direct_output;
+	uint32_t f_cpu;
+	char const * cache_dir; //NULL if not used
+	char output_file_name[PATH_MAX];
+	float ubbr_value_float;
+	uint16_t ubbr_value;
+	loop_t loop; //loop.start is LOOP_NONE without --loop
+
+	//results
+	bool cached;
+	stream_t stream;
+	double duration;
+} multi_variant_t;
+
+//--osr 26,35,48,70, returns the number of OSRs or 0 if the list is invalid
+static uint8_t parse_osr_list(char const * const list, uint8_t * const osrs)
+{
+	uint8_t nb=0;
+	char const * p=list;
+	while(1)
+	{
+		char * end;
+		unsigned long osr=strtoul(p, &end, 10);
+		if(end==p || osr==0 || osr>UINT8_MAX || nb==MULTI_MAX_OSR || (*end!=',' && *end!='\0') || memchr(osrs, osr, nb))
+			return 0;
+		osrs[nb++]=osr;
+		if(*end=='\0')
+			return nb;
+		p=end+1;
+	}
+}
+
+//out.bin with OSR 26 becomes out_osr26.bin
+static void multi_output_name(char * const name, const size_t size, char const * const output_file_name, const uint8_t osr)
+{
+	char const * base=strrchr(output_file_name, '/');
+	base=base?base+1:output_file_name;
+	char const * dot=strrchr(base, '.');
+	if(!dot || dot==base)
+		dot=base+strlen(base);
+
+	if(snprintf(name, size, "%.*s_osr%u%s", (int)(dot-output_file_name), output_file_name, osr, dot)>=(int)size)
+		errx(1, "output file name %s is too long", output_file_name);
+}
+
+static void * multi_worker(void * arg)
+{
+	multi_variant_t * const v=arg;
+	double start=batch_time();
+
+	uint64_t cache_key=0;
+	if(v->cache_dir)
+	{
+		uint8_t codec=v->output_pcm8?PDM_HEADER_CODEC_PCM8:(v->output_compressed?PDM_HEADER_CODEC_HUFFMAN:PDM_HEADER_CODEC_NONE);
+		cache_key=cache_hash_pcm(cache_key_start(v->oversampling_ratio, codec, v->with_header, v->f_cpu, v->sample_rate, v->nb_samples, v->loop.start), v->data, v->nb_samples);
+		if(cache_fetch(v->cache_dir, cache_key, v->output_file_name))
+		{
+			struct stat st;
+			if(stat(v->output_file_name, &st))
+				err(1, "reading output file %s failed", v->output_file_name);
+			v->cached=true;
+			v->stream.nb_bytes=st.st_size-(v->with_header?512:0);
+			v->duration=batch_time()-start;
+			return NULL;
+		}
+	}
+
+	write_output(v->data, v->nb_samples, v->sample_rate, v->output_file_name, -1, v->direct_output, v->oversampling_ratio, v->output_pcm8, v->output_compressed, v->with_header, v->f_cpu, v->ubbr_value, (v->loop.start!=LOOP_NONE)?&v->loop:NULL, &v->stream);
+
+	if(v->cache_dir)
+		cache_store(v->cache_dir, cache_key, v->output_file_name);
+
+	v->duration=batch_time()-start;
+	return NULL;
+}
+
+static int convert_multi(int16_t const * const data, const uint32_t nb_samples, const uint16_t sample_rate, char const * const output_file_name, uint8_t const * const osrs, const uint8_t nb_osr, const bool output_pcm8, const bool output_compressed, const bool with_header, const bool direct_output, const uint32_t f_cpu, char const * const cache_dir, const uint32_t loop_start)
+{
+	multi_variant_t * variants=calloc(nb_osr, sizeof(multi_variant_t));
+	pthread_t threads[MULTI_MAX_OSR];
+	if(!variants)
+		err(1, "calloc for variants failed");
+
+	//everything that can fail is checked before the first output is written
+	uint8_t i;
+	for(i=0; i<nb_osr; i++)
+	{
+		multi_variant_t * const v=&variants[i];
+		v->data=data;
+		v->nb_samples=nb_samples;
+		v->sample_rate=sample_rate;
+		v->oversampling_ratio=osrs[i];
+		v->output_pcm8=output_pcm8;
+		v->output_compressed=output_compressed;
+		v->with_header=with_header;
+		v->direct_output=direct_output;
+		v->f_cpu=f_cpu;
+		v->cache_dir=cache_dir;
+		multi_output_name(v->output_file_name, sizeof(v->output_file_name), output_file_name, osrs[i]);
+
+		if((uint64_t)2*osrs[i]*nb_samples>UINT32_MAX-7)
+			errx(1, "input file is too long for OSR %u", osrs[i]);
+		v->loop.start=LOOP_NONE;
+		char const * error;
+		if(loop_start!=LOOP_NONE && (error=loop_init(&v->loop, loop_start, nb_samples, osrs[i], output_pcm8)))
+			errx(1, "OSR %u: %s", osrs[i], error);
+		if(!calc_ubbr(f_cpu, sample_rate, osrs[i], &v->ubbr_value_float, &v->ubbr_value))
+			errx(1, "OSR %u can't be done with a %uHz clock", osrs[i], f_cpu);
+		if(!prepare_output(v->output_file_name) && cache_dir)
+			errx(1, "--cache needs regular output files, %s isn't", v->output_file_name);
+	}
+
+	if(output_compressed)
+		codec_build_codes();
+
+	printf("converting %u OSRs in parallel...", nb_osr); fflush(stdout);
+
+	double start=batch_time();
+	for(i=0; i<nb_osr; i++)
+	{
+		if(pthread_create(&threads[i], NULL, multi_worker, &variants[i]))
+			errx(1, "creating thread failed");
+	}
+	for(i=0; i<nb_osr; i++)
+		pthread_join(threads[i], NULL);
+	double duration=batch_time()-start;
+
+	printf(" all done!\n\nAVR configuration assuming a %.3fMHz clock:\n", f_cpu/1E6);
+
+	double slowest=0;
+	for(i=0; i<nb_osr; i++)
+	{
+		multi_variant_t const * const v=&variants[i];
+		printf("  OSR %u: \"%s\", UBBR %.2f -> %u, %llu sectors", v->oversampling_ratio, v->output_file_name, v->ubbr_value_float, v->ubbr_value, (unsigned long long)v->stream.nb_bytes/512);
+		if(v->loop.start!=LOOP_NONE && !v->cached)
+			printf(", loop %u to %u", v->loop.start_sector, v->loop.end_sector);
+		if(v->cached)
+			printf(", from cache");
+		else
+		{
+			if(output_compressed && v->stream.nb_bytes_pdm)
+				printf(" (compressed to %.1f%%)", 100.0*v->stream.nb_bytes/v->stream.nb_bytes_pdm);
+			printf(", %.3fs", v->duration);
+		}
+		printf("\n");
+		if(v->duration>slowest)
+			slowest=v->duration;
+	}
+
+	printf("\n%u outputs in %.3fs, the slowest took %.3fs.\n", nb_osr, duration, slowest);
+	if(with_header)
+		printf("The firmware takes UBBR and size from the header%s.\n\n", output_pcm8?", set PCM_MODE to 1":(output_compressed?", compile it with COMPRESSED":""));
+	else
+		printf("Don't forget adjusting UBBR, file name and size in the firmware.\n\n");
+
+	free(variants);
+
+	return 0;
+}
+
+//--selftest and --bench: synthetic input, no files needed
+//the signals are made with integer arithmetic only so they are the same everywhere, the output is compared with known good hashes (FNV-1a 64 bit) of the whole output
+
+#define SELFTEST_NB_SAMPLES 8000 //per signal, 0.5s at 16kHz
+#define SELFTEST_SAMPLE_RATE 16000
+#define BENCH_SECONDS 10 //of audio per OSR
+
+enum { SIGNAL_SILENCE, SIGNAL_SINE, SIGNAL_SWEEP, SIGNAL_FULL_SCALE, SIGNAL_CLIPPING, SIGNAL_NOISE, NB_SIGNALS };
+static char const * const signal_names[NB_SIGNALS]={ "silence", "sine", "sweep", "full-scale", "clipping", "noise" };
+
+//magic circle oscillator in Q16, k is 2*sin(pi*f/fs), k_end!=k_start gives a linear sweep
+//the peaks are about amplitude/sqrt(1-k*k/4), 2% more than amplitude at 1kHz
+static void make_oscillator(int16_t * const data, const uint32_t nb_samples, const int64_t amplitude, const int64_t k_start, const int64_t k_end)
+{
+	int64_t x=amplitude<<16, y=0;
+	uint32_t i;
+	for(i=0; i<nb_samples; i++)
+	{
+		int64_t k=k_start+(k_end-k_start)*i/nb_samples;
+		x-=y*k/65536;
+		y+=x*k/65536;
+		int64_t s=x/65536;
+		data[i]=(s>32767)?32767:((s<-32768)?-32768:s);
+	}
+}
+
+static void make_signal(const uint8_t signal, int16_t * const data, const uint32_t nb_samples)
+{
+	uint32_t state=1;
+	uint32_t i;
+	switch(signal)
+	{
+		case SIGNAL_SILENCE: memset(data, 0, nb_samples*sizeof(int16_t)); break;
+		case SIGNAL_SINE: make_oscillator(data, nb_samples, 16384, 25572, 25572); break; //1kHz at 16kHz, -6dBFS
+		case SIGNAL_SWEEP: make_oscillator(data, nb_samples, 16384, 515, 92682); break; //about 20Hz to fs/4, the level rises to about -5dBFS
+		case SIGNAL_FULL_SCALE: make_oscillator(data, nb_samples, 32180, 25572, 25572); break; //peaks just below full scale
+		case SIGNAL_CLIPPING: make_oscillator(data, nb_samples, 65534, 8219, 8219); break; //about 320Hz, 6dB too loud
+		case SIGNAL_NOISE:
+			for(i=0; i<nb_samples; i++)
+			{
+				state=state*1664525+1013904223;
+				data[i]=(int16_t)(state>>16)/4;
+			}
+			break;
+	}
+}
+
+typedef struct
+{
+	uint8_t signal;
+	uint8_t osr;
+	uint8_t codec; //PDM_HEADER_CODEC_xxx
+	uint64_t hash; //of the output without header
+} selftest_case_t;
+
+static const selftest_case_t selftest_cases[]=
+{
+	{ SIGNAL_SILENCE, 1, PDM_HEADER_CODEC_NONE, 0xb40a6d02ac4735b5ULL },
+	{ SIGNAL_SILENCE, 13, PDM_HEADER_CODEC_NONE, 0x005aaee810310c7cULL },
+	{ SIGNAL_SILENCE, 32, PDM_HEADER_CODEC_NONE, 0xfda55ee7e09ece95ULL },
+	{ SIGNAL_SILENCE, 64, PDM_HEADER_CODEC_NONE, 0x7b09bc6ed557abaaULL },
+	{ SIGNAL_SILENCE, 255, PDM_HEADER_CODEC_NONE, 0x9049c8248eca7199ULL },
+	{ SIGNAL_SILENCE, 32, PDM_HEADER_CODEC_HUFFMAN, 0xae887fe36f8d5a11ULL },
+	{ SIGNAL_SILENCE, 64, PDM_HEADER_CODEC_HUFFMAN, 0x2604cd6e146dc1dcULL },
+	{ SIGNAL_SILENCE, 32, PDM_HEADER_CODEC_PCM8, 0xb9d103fd6854a325ULL },
+	{ SIGNAL_SINE, 1, PDM_HEADER_CODEC_NONE, 0x9789929473b0b606ULL },
+	{ SIGNAL_SINE, 13, PDM_HEADER_CODEC_NONE, 0xa0dba2df4517d4deULL },
+	{ SIGNAL_SINE, 32, PDM_HEADER_CODEC_NONE, 0x9ea469bab2233ce5ULL },
+	{ SIGNAL_SINE, 64, PDM_HEADER_CODEC_NONE, 0xac90991f3812f123ULL },
+	{ SIGNAL_SINE, 255, PDM_HEADER_CODEC_NONE, 0x32a5ae4d6b8d86f5ULL },
+	{ SIGNAL_SINE, 32, PDM_HEADER_CODEC_HUFFMAN, 0x2df1c056517e126bULL },
+	{ SIGNAL_SINE, 64, PDM_HEADER_CODEC_HUFFMAN, 0xc78b8e79200e9177ULL },
+	{ SIGNAL_SINE, 32, PDM_HEADER_CODEC_PCM8, 0xbda737903ae7f852ULL },
+	{ SIGNAL_SWEEP, 1, PDM_HEADER_CODEC_NONE, 0x8d83afa8fc2e4e65ULL },
+	{ SIGNAL_SWEEP, 13, PDM_HEADER_CODEC_NONE, 0x4a1d45ecefd31e34ULL },
+	{ SIGNAL_SWEEP, 32, PDM_HEADER_CODEC_NONE, 0xba4b68f1ed952678ULL },
+	{ SIGNAL_SWEEP, 64, PDM_HEADER_CODEC_NONE, 0x2dcdddc72fc9f1d6ULL },
+	{ SIGNAL_SWEEP, 255, PDM_HEADER_CODEC_NONE, 0xed0dd793a7519962ULL },
+	{ SIGNAL_SWEEP, 32, PDM_HEADER_CODEC_HUFFMAN, 0xac4945b025b6c559ULL },
+	{ SIGNAL_SWEEP, 64, PDM_HEADER_CODEC_HUFFMAN, 0x374468b702f43bc0ULL },
+	{ SIGNAL_SWEEP, 32, PDM_HEADER_CODEC_PCM8, 0x404f4c207b5a3274ULL },
+	{ SIGNAL_FULL_SCALE, 1, PDM_HEADER_CODEC_NONE, 0xd26c3b160cf2206cULL },
+	{ SIGNAL_FULL_SCALE, 13, PDM_HEADER_CODEC_NONE, 0x58b970c7e731db76ULL },
+	{ SIGNAL_FULL_SCALE, 32, PDM_HEADER_CODEC_NONE, 0x1350e6718b0f90b9ULL },
+	{ SIGNAL_FULL_SCALE, 64, PDM_HEADER_CODEC_NONE, 0x601a6e4c0916f1b6ULL },
+	{ SIGNAL_FULL_SCALE, 255, PDM_HEADER_CODEC_NONE, 0x295a2dcf4c899952ULL },
+	{ SIGNAL_FULL_SCALE, 32, PDM_HEADER_CODEC_HUFFMAN, 0xe67cb5787635ab29ULL },
+	{ SIGNAL_FULL_SCALE, 64, PDM_HEADER_CODEC_HUFFMAN, 0x1b29a49cc1dcd4d6ULL },
+	{ SIGNAL_FULL_SCALE, 32, PDM_HEADER_CODEC_PCM8, 0xc5adedc742f228ddULL },
+	{ SIGNAL_CLIPPING, 1, PDM_HEADER_CODEC_NONE, 0xf73c3bb6f8212582ULL },
+	{ SIGNAL_CLIPPING, 13, PDM_HEADER_CODEC_NONE, 0xfd344cd2b97916e7ULL },
+	{ SIGNAL_CLIPPING, 32, PDM_HEADER_CODEC_NONE, 0x6a1b9cf0d17e8e35ULL },
+	{ SIGNAL_CLIPPING, 64, PDM_HEADER_CODEC_NONE, 0xcb3567e97149c130ULL },
+	{ SIGNAL_CLIPPING, 255, PDM_HEADER_CODEC_NONE, 0x5a7e13fd88dc3778ULL },
+	{ SIGNAL_CLIPPING, 32, PDM_HEADER_CODEC_HUFFMAN, 0xf2f4f346d257e0bdULL },
+	{ SIGNAL_CLIPPING, 64, PDM_HEADER_CODEC_HUFFMAN, 0x53fd3bb2299a2dd0ULL },
+	{ SIGNAL_CLIPPING, 32, PDM_HEADER_CODEC_PCM8, 0x90aab56d1bdcdf36ULL },
+	{ SIGNAL_NOISE, 1, PDM_HEADER_CODEC_NONE, 0x09f8eea43e18015cULL },
+	{ SIGNAL_NOISE, 13, PDM_HEADER_CODEC_NONE, 0x37d9d43834c883fbULL },
+	{ SIGNAL_NOISE, 32, PDM_HEADER_CODEC_NONE, 0x3261dddf88e939c1ULL },
+	{ SIGNAL_NOISE, 64, PDM_HEADER_CODEC_NONE, 0xd4de7f8750a2a6f3ULL },
+	{ SIGNAL_NOISE, 255, PDM_HEADER_CODEC_NONE, 0xdc268bbf1cb7650aULL },
+	{ SIGNAL_NOISE, 32, PDM_HEADER_CODEC_HUFFMAN, 0x518cd70eb9f25bb0ULL },
+	{ SIGNAL_NOISE, 64, PDM_HEADER_CODEC_HUFFMAN, 0xf0cc08aed4e63f0bULL },
+	{ SIGNAL_NOISE, 32, PDM_HEADER_CODEC_PCM8, 0xea515cdccc2c9e2bULL },
+};
+
+static uint64_t hash_fd(const int fd)
+{
+	uint64_t hash=CACHE_FNV_OFFSET;
+	uint8_t buffer[CACHE_COPY_BUFFER_SIZE];
+	size_t nb_read;
+	if(lseek(fd, 0, SEEK_SET))
+		err(1, "seeking in temporary file failed");
+	do
+	{
+		if(!read_all(fd, buffer, sizeof(buffer), &nb_read))
+			err(1, "reading temporary file failed");
+		hash=cache_hash(hash, buffer, nb_read);
+	} while(nb_read==sizeof(buffer));
+	return hash;
+}
+
+//deleted as soon as it is closed
+static int temporary_fd(void)
+{
+	char name[]="/tmp/pdmconv.XXXXXX";
+	int fd=mkstemp(name);
+	if(fd<0)
+		err(1, "creating temporary file failed");
+	unlink(name);
+	return fd;
+}
+
+//both ways a file is converted: mapped through the double buffer (single file) and read block by block (--raw-in, --batch)
+static bool selftest_case(selftest_case_t const * const c, int16_t const * const data, const uint32_t nb_samples)
+{
+	bool pcm8=(c->codec==PDM_HEADER_CODEC_PCM8), compressed=(c->codec==PDM_HEADER_CODEC_HUFFMAN);
+
+	int fd=temporary_fd();
+	writer_t writer;
+	writer_open(&writer, "temporary file", fd, false);
+	stream_t stream;
+	convert_mapped(data, nb_samples, &writer, c->osr, pcm8, compressed, false, NULL, &stream);
+	writer_finish(&writer);
+	writer_close(&writer);
+	uint64_t hash_mapped=hash_fd(fd);
+	close(fd);
+
+	int fd_in=temporary_fd();
+	uint32_t i;
+	for(i=0; i<nb_samples; i++)
+	{
+		uint8_t s[2]={ (uint16_t)data[i]&0xFF, (uint16_t)data[i]>>8 };
+		write_all(fd_in, s, 2, "temporary file");
+	}
+	if(lseek(fd_in, 0, SEEK_SET))
+		err(1, "seeking in temporary file failed");
+	fd=temporary_fd();
+	FILE * out=fdopen(fd, "w+b");
+	uint64_t nb_samples_stream, nb_bytes_pdm, nb_bytes_written;
+	convert_stream(fd_in, UINT64_MAX, out, c->osr, pcm8, compressed, false, &nb_samples_stream, &nb_bytes_pdm, &nb_bytes_written);
+	fflush(out);
+	uint64_t hash_stream=hash_fd(fd);
+	fclose(out);
+	close(fd_in);
+
+	bool ok=(hash_mapped==c->hash && hash_stream==c->hash);
+	printf("  %-10s OSR %3u %-10s ", signal_names[c->signal], c->osr, pcm8?"pcm8":(compressed?"compressed":"plain"));
+	if(ok)
+		printf("ok\n");
+	else if(hash_mapped==hash_stream)
+		printf("FAILED, output has hash 0x%016llx\n", (unsigned long long)hash_mapped);
+	else
+		printf("FAILED, single file and stream mode differ (0x%016llx, 0x%016llx)\n", (unsigned long long)hash_mapped, (unsigned long long)hash_stream);
+	return ok;
+}
+
+static int selftest(void)
+{
+	int16_t * data=malloc(SELFTEST_NB_SAMPLES*sizeof(int16_t));
+	if(!data)
+		err(1, "malloc for test signal failed");
+
+	codec_build_codes();
+
+	uint32_t nb_failed=0;
+	uint32_t i;
+	for(i=0; i<sizeof(selftest_cases)/sizeof(selftest_case_t); i++)
+	{
+		make_signal(selftest_cases[i].signal, data, SELFTEST_NB_SAMPLES);
+		nb_failed+=!selftest_case(&selftest_cases[i], data, SELFTEST_NB_SAMPLES);
+	}
+
+	free(data);
+
+	printf("\n%u of %u tests failed.\n\n", nb_failed, (uint32_t)(sizeof(selftest_cases)/sizeof(selftest_case_t)));
+
+	return nb_failed?1:0;
+}
+
+static double cpu_time(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+	return t.tv_sec+t.tv_nsec/1E9;
+}
+
+//modulator (and codec) only, without any I/O
+static int bench(void)
+{
+	static const uint8_t osrs[]={ 16, 32, 64, 128, 255 };
+	const uint32_t nb_samples=BENCH_SECONDS*SELFTEST_SAMPLE_RATE;
+
+	int16_t * data=malloc(nb_samples*sizeof(int16_t));
+	if(!data)
+		err(1, "malloc for test signal failed");
+	make_signal(SIGNAL_SWEEP, data, nb_samples);
+
+	codec_build_codes();
+
+	printf("%us of a sweep at %ukHz:\n", BENCH_SECONDS, SELFTEST_SAMPLE_RATE/1000);
+
+	double start_total=batch_time();
+	uint8_t i, compressed;
+	for(i=0; i<sizeof(osrs); i++)
+	{
+		for(compressed=0; compressed<2; compressed++)
+		{
+			stream_t stream;
+			double start=batch_time(), start_cpu=cpu_time();
+			convert_mapped(data, nb_samples, NULL, osrs[i], false, compressed, false, NULL, &stream);
+			double duration=batch_time()-start, duration_cpu=cpu_time()-start_cpu;
+			double bits=2.0*osrs[i]*nb_samples;
+
+			printf("  OSR %3u %-10s %7.3fs wall %7.3fs CPU, %7.1f Mbit/s, %6.1f ns/bit, %6.0fx realtime\n", osrs[i], compressed?"compressed":"plain", duration, duration_cpu, bits/duration_cpu/1E6, duration_cpu/bits*1E9, BENCH_SECONDS/duration_cpu);
+		}
+	}
+
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	printf("\ntotal %.3fs wall, peak RSS %ldkB\n\n", batch_time()-start_total, usage.ru_maxrss);
+
+	free(data);
+
+	return 0;
+}
+
+static void print_banner(void)
+{
+	printf("\nThis is pdmconv version 1 (c) 2022 by kittennbfive\nThis tool is released under AGPLv3+ and comes WITHOUT ANY WARRANTY!\n\n");
+}
+
 void print_usage_and_exit(void)
 {
-	printf("usage: pdmconv --osr $osr infile.wav outfile\n\n$osr is the oversampling ratio, higher means better quality.\nInput wave file must be single channel 16 bit signed PCM with 8kHz or 16kHz sampling rate.\nOutput file can be transfered to formated SD-card as a regular file or written as raw image using dd.\nWarning: An existing file will be overwritten!\nPlease read the documentation.\n\n");
+	print_banner();
+	printf("usage: pdmconv --osr $osr[,$osr...] [--pcm8|--compress] [--fcpu $fcpu] [--no-header] [--cache $dir] [--direct] [--loop $sample] infile.wav outfile\n       pdmconv --auto --budget $budget|--card fs|raw --min-snr $snr [--formats $list] [--fcpu $fcpu] [--no-header] infile.wav outfile\n       pdmconv --decode [--osr $osr --rate $rate [--pcm8|--compress]] infile outfile.wav [source.wav]\n       pdmconv --raw-in s16le --rate $rate --osr $osr [--pcm8|--compress] [--fcpu $fcpu] infile|- outfile\n       pdmconv --batch --osr $osr [--pcm8|--compress] [--fcpu $fcpu] [--no-header] [--cache $dir] indir outdir\n       pdmconv --selftest|--bench\n\n$osr is the oversampling ratio, higher means better quality. With a list like 26,35,48,70 the input is read once and converted for every OSR in parallel, outfile.bin becomes outfile_osr26.bin and so on.\n$fcpu is the clock of the AVR in Hz, default 20000000.\n--no-header omits the header sector, you need to adjust UBBR (and the number of sectors) in the firmware then.\n--pcm8 writes 8 bit PCM for the PCM_MODE of the firmware instead of PDM-data, the AVR will do the modulation. $osr must be a multiple of 4 then.\n--compress writes losslessly compressed PDM-data for the COMPRESSED mode of the firmware.\n--auto chooses OSR and format: the card must not need more than $budget bytes per second (or --card fs or raw for about 100000 or 140000) and the SNR as --decode reports it must be at least $snr dB. --formats restricts the search, default plain,compressed,pcm8.\n--decode turns a file made by pdmconv back into a wave file, if the source wave file is given it prints SNR, THD+N and in-band noise. Files without header need --osr, --rate and the codec option.\n--raw-in s16le reads 16 bit signed little endian PCM without any header at $rate (8000 or 16000) and converts it block by block as it arrives, - reads from stdin. The output is the same as with --no-header.\nOutfile - writes to stdout, all messages go to stderr then.\n--batch converts every .wav in indir to a .bin of the same name in outdir, using all cores, and reports the speed in samples per second.\n--cache keeps every output in $dir under a hash of audio-data, options and converter version, an unchanged file is copied (reflinked where possible) from there instead of converted again.\n--direct writes the output with O_DIRECT, bypassing the page cache, meant for writing straight to a card like /dev/sdX.\n--loop makes the firmware play from sample $sample to the end over and over, the loop is stored in the header as sectors. Silence before and copies of the loop may be added so both ends fall on a sector.\n--selftest converts synthetic signals and compares the output with known good hashes, --bench measures the speed of the modulator.\nInput wave file must be single channel 16 bit signed PCM with 8kHz or 16kHz sampling rate.\nOutput file can be transfered to formated SD-card as a regular file or written as raw image using dd.\nWarning: An existing file will be overwritten!\nPlease read the documentation.\n\n");
 	exit(0);
 }
 
@@ -57,7 +2752,25 @@ int main(int argc, char **argv)
 {
 	const struct option optiontable[]=
 	{
-		{ "osr",		required_argument,	NULL,	0 }, //mandatory!
+		{ "osr",		required_argument,	NULL,	0 }, //mandatory unless --auto!
+		{ "pcm8",		no_argument,		NULL,	1 },
+		{ "compress",	no_argument,		NULL,	2 },
+		{ "fcpu",		required_argument,	NULL,	3 },
+		{ "no-header",	no_argument,		NULL,	4 },
+		{ "decode",		no_argument,		NULL,	5 },
+		{ "rate",		required_argument,	NULL,	6 },
+		{ "auto",		no_argument,		NULL,	7 },
+		{ "budget",		required_argument,	NULL,	8 },
+		{ "card",		required_argument,	NULL,	9 },
+		{ "min-snr",	required_argument,	NULL,	10 },
+		{ "formats",	required_argument,	NULL,	11 },
+		{ "raw-in",		required_argument,	NULL,	12 },
+		{ "batch",		no_argument,		NULL,	13 },
+		{ "cache",		required_argument,	NULL,	14 },
+		{ "direct",		no_argument,		NULL,	15 },
+		{ "selftest",	no_argument,		NULL,	16 },
+		{ "bench",		no_argument,		NULL,	17 },
+		{ "loop",		required_argument,	NULL,	18 },
 		{ "version",	no_argument,		NULL, 	100 },
 		{ "help",		no_argument,		NULL, 	101 },
 		{ "usage",		no_argument,		NULL, 	101 },
@@ -71,7 +2784,25 @@ int main(int argc, char **argv)
 
 	bool only_print_version=false;
 
-	printf("\nThis is pdmconv version 1 (c) 2022 by kittennbfive\nThis tool is released under AGPLv3+ and comes WITHOUT ANY WARRANTY!\n\n");
+	bool output_pcm8=false;
+	bool output_compressed=false;
+	bool with_header=true;
+	uint32_t f_cpu=20000000;
+	bool decode_input=false;
+	uint16_t raw_sample_rate=0; //for --decode and --raw-in
+	bool auto_select_osr=false;
+	uint32_t auto_budget=0;
+	double auto_min_snr=NAN;
+	uint8_t auto_formats=AUTO_PLAIN|AUTO_COMPRESSED|AUTO_PCM8;
+	bool raw_input=false;
+	bool batch_convert=false;
+	char const * cache_dir=NULL;
+	bool direct_output=false;
+	bool run_selftest=false;
+	bool run_bench=false;
+	uint32_t loop_start=LOOP_NONE;
+	uint8_t osrs[MULTI_MAX_OSR];
+	uint8_t nb_osr=1;
 
 	if(argc==1)
 		print_usage_and_exit();
@@ -81,7 +2812,53 @@ int main(int argc, char **argv)
 		switch(opt)
 		{
 			case '?': print_usage_and_exit(); break;
-			case 0: oversampling_ratio=atoi(optarg); break;
+			case 0:
+				nb_osr=parse_osr_list(optarg, osrs);
+				if(!nb_osr)
+					errx(1, "invalid value for --osr, must be 1 to 255 or a list like 26,35,48,70");
+				oversampling_ratio=osrs[0];
+				break;
+			case 1: output_pcm8=true; break;
+			case 2: output_compressed=true; break;
+			case 3: f_cpu=atol(optarg); break;
+			case 4: with_header=false; break;
+			case 5: decode_input=true; break;
+			case 6: raw_sample_rate=atoi(optarg); break;
+			case 7: auto_select_osr=true; break;
+			case 8: auto_budget=atol(optarg); break;
+			case 9:
+				if(!strcmp(optarg, "fs"))
+					auto_budget=AUTO_CARD_FS;
+				else if(!strcmp(optarg, "raw"))
+					auto_budget=AUTO_CARD_RAW;
+				else
+					errx(1, "invalid value for --card, must be fs or raw");
+				break;
+			case 10: auto_min_snr=atof(optarg); break;
+			case 11:
+				auto_formats=auto_parse_formats(optarg);
+				if(!auto_formats)
+					errx(1, "invalid value for --formats");
+				break;
+			case 12:
+				if(strcmp(optarg, "s16le"))
+					errx(1, "invalid value for --raw-in, only s16le is supported");
+				raw_input=true;
+				break;
+			case 13: batch_convert=true; break;
+			case 14: cache_dir=optarg; break;
+			case 15: direct_output=true; break;
+			case 16: run_selftest=true; break;
+			case 17: run_bench=true; break;
+			case 18:
+			{
+				char * end;
+				unsigned long start=strtoul(optarg, &end, 10);
+				if(end==optarg || *end || start>=LOOP_NONE)
+					errx(1, "invalid value for --loop, must be a sample number");
+				loop_start=start;
+				break;
+			}
 			case 100: only_print_version=true; break;
 			case 101: print_usage_and_exit(); break;
 
@@ -89,164 +2866,233 @@ int main(int argc, char **argv)
 		}
 	}
 
-	if(only_print_version)
-		return 0;
-
-	if(oversampling_ratio==0)
-		errx(1, "invalid value or missing argument --osr");
-
-	if(argc!=5)
-		errx(1, "missing input and/or output file name");
+	//with - as output file the data goes to stdout, so everything else goes to stderr
+	FILE * stdout_data=NULL;
+	if(argc-optind>=2 && !strcmp(argv[optind+1], "-"))
+	{
+		int fd=dup(STDOUT_FILENO);
+		if(fd<0 || dup2(STDERR_FILENO, STDOUT_FILENO)<0 || !(stdout_data=fdopen(fd, "wb")))
+			err(1, "redirecting stdout failed");
+	}
 
-	char input_file_name[50], output_file_name[50];
+	print_banner();
 
-	strncpy(input_file_name, argv[optind], 49);
+	if(only_print_version)
+		return 0;
 
-	strncpy(output_file_name, argv[optind+1], 49);
+	if(run_selftest || run_bench)
+	{
+		int ret=0;
+		if(run_selftest)
+			ret=selftest();
+		if(run_bench)
+			ret|=bench();
+		return ret;
+	}
 
-	printf("Input file: \"%s\"\nOutput file: \"%s\"\n\n", input_file_name, output_file_name);
+	if(output_pcm8 && output_compressed)
+		errx(1, "--pcm8 and --compress can't be used together");
 
-	FILE * inp=fopen(input_file_name, "rb");
-	if(!inp)
-		err(1, "opening input file %s failed", input_file_name);
+	if(nb_osr>1 && (decode_input || auto_select_osr || raw_input || batch_convert || stdout_data))
+		errx(1, "a list of OSRs only works for a single wave file written to files");
 
-	wav_header_t header;
-	if(fread(&header, sizeof(wav_header_t), 1, inp)!=1)
-		err(1, "reading file header failed");
+	if(loop_start!=LOOP_NONE && (decode_input || raw_input || batch_convert || !with_header))
+		errx(1, "--loop needs a single wave file and the header, the loop is stored there");
 
-	if(memcmp(header.chunkID, "RIFF", 4))
-		errx(1, "not a wav file, invalid chunkID");
+	if(decode_input)
+	{
+		if(argc-optind!=2 && argc-optind!=3)
+			errx(1, "missing input and/or output file name");
+		if(stdout_data || raw_input || cache_dir || direct_output)
+			errx(1, "--decode works on files only and doesn't use the cache or --direct");
 
-	if(memcmp(header.riffType, "WAVE", 4))
-		errx(1, "not a wav file, invalid RIFFtype");
+		return decode(argv[optind], argv[optind+1], (argc-optind==3)?argv[optind+2]:NULL, oversampling_ratio, raw_sample_rate, output_pcm8?PDM_HEADER_CODEC_PCM8:(output_compressed?PDM_HEADER_CODEC_HUFFMAN:PDM_HEADER_CODEC_NONE));
+	}
 
-	wav_fmt_t fmt;
-	if(fread(&fmt, sizeof(wav_fmt_t), 1, inp)!=1)
-		err(1, "reading fmt block failed");
+	if(f_cpu==0)
+		errx(1, "invalid value for --fcpu");
 
-	if(memcmp(fmt.fmt_sig, "fmt ", 4))
-		errx(1, "fmt block has invalid signature");
+	if(direct_output && (stdout_data || raw_input || batch_convert))
+		errx(1, "--direct only works for a single file written to a file or device");
 
-	if(fmt.fmt_size!=16)
-		errx(1, "fmt block has wrong size");
+	if(cache_dir && mkdir(cache_dir, 0755) && errno!=EEXIST)
+		err(1, "creating cache directory %s failed", cache_dir);
 
-	if(fmt.fmt_tag!=0x0001)
-		errx(1, "wrong data format, only plain PCM supported");
+	if(auto_select_osr)
+	{
+		if(oversampling_ratio || output_pcm8 || output_compressed)
+			errx(1, "--auto chooses OSR and format itself, use --formats to restrict the format");
+		if(auto_budget==0)
+			errx(1, "--auto needs --budget or --card");
+		if(isnan(auto_min_snr))
+			errx(1, "--auto needs --min-snr");
+	}
+	else if(oversampling_ratio==0)
+		errx(1, "invalid value or missing argument --osr");
 
-	if(fmt.channels!=1)
-		errx(1, "too many channels in file, only mono supported");
+	uint8_t i;
+	for(i=0; i<nb_osr; i++)
+	{
+		if(output_pcm8 && (osrs[i]%4))
+			errx(1, "--osr must be a multiple of 4 with --pcm8");
+	}
 
-	if(fmt.sample_rate!=8000 && fmt.sample_rate!=16000)
-		errx(1, "wrong sample rate, only 8kHz or 16kHz supported");
+	if(argc-optind!=2)
+		errx(1, "missing input and/or output file name");
 
-	uint16_t sample_rate=fmt.sample_rate;
+	if(batch_convert)
+	{
+		if(auto_select_osr || raw_input || stdout_data)
+			errx(1, "--batch needs --osr and two directories");
 
-	if(fmt.bits_per_sample!=16)
-		errx(1, "wrong number of bits per sample, only 16 bits supported");
+		return convert_batch(argv[optind], argv[optind+1], oversampling_ratio, output_pcm8, output_compressed, with_header, f_cpu, cache_dir);
+	}
 
-	wav_data_t wav_data;
-	if(fread(&wav_data, sizeof(wav_data_t), 1, inp)!=1)
-		err(1, "reading header of wave data block failed");
+	char const * const input_file_name=argv[optind];
+	char const * const output_file_name=argv[optind+1];
 
-	if(memcmp(wav_data.data_sig, "data", 4))
-		errx(1, "header of wave data block has invalid signature");
+	printf("Input file: \"%s\"\nOutput file: \"%s\"\n\n", input_file_name, output_file_name);
 
-	uint32_t nb_samples=wav_data.length/(16/8);
+	if(raw_input)
+	{
+		if(auto_select_osr || cache_dir)
+			errx(1, "--auto and --cache need the whole file, they can't be used with --raw-in");
+		if(raw_sample_rate!=8000 && raw_sample_rate!=16000)
+			errx(1, "--raw-in needs --rate 8000 or 16000");
 
-	printf("Input file contains %u bytes or %u samples of audio data at sampling rate %ukHz.\n", wav_data.length, nb_samples, sample_rate/1000);
+		float ubbr_value_float;
+		uint16_t ubbr_value;
+		if(!calc_ubbr(f_cpu, raw_sample_rate, oversampling_ratio, &ubbr_value_float, &ubbr_value))
+			errx(1, "this OSR can't be done with a %uHz clock", f_cpu);
 
-	uint32_t nb_samples_output=2*oversampling_ratio*nb_samples;
-	uint32_t nb_bytes_output=nb_samples_output/8;
+		printf("AVR configuration assuming a %.3fMHz clock: UBBR %.2f -> %u\nThere is no header with --raw-in, set UBBR%s and the number of sectors in the firmware.\n\n", f_cpu/1E6, ubbr_value_float, ubbr_value, output_pcm8?" (or OSR for PCM_MODE)":"");
 
-	printf("Output file will contain %u samples and be about %.3fMB or %u sectors (512B each).\n\n", nb_samples_output, (float)nb_bytes_output/1024/1024, nb_bytes_output/512);
+		int fd_in=strcmp(input_file_name, "-")?open(input_file_name, O_RDONLY):STDIN_FILENO;
+		if(fd_in<0)
+			err(1, "opening input file %s failed", input_file_name);
 
-	float ubbr_value_float=20E6/(2*sample_rate*oversampling_ratio*2)-1;
-	uint16_t ubbr_value=(uint16_t)(ubbr_value_float+0.5);
+		if(!stdout_data)
+			prepare_output(output_file_name);
+		FILE * out=stdout_data?stdout_data:fopen(output_file_name, "wb");
+		if(!out)
+			err(1, "creating output file %s failed", output_file_name);
 
-	printf("AVR configuration assuming a 20MHz crystal: UBBR %.2f -> %u\n\n", ubbr_value_float, ubbr_value);
+		if(output_compressed)
+			codec_build_codes();
 
-	int16_t * data=malloc(nb_samples*sizeof(int16_t));
-	if(!data)
-		err(1, "malloc for input audio data failed");
+		uint64_t nb_samples, nb_bytes_pdm, nb_bytes_written;
+		convert_stream(fd_in, UINT64_MAX, out, oversampling_ratio, output_pcm8, output_compressed, true, &nb_samples, &nb_bytes_pdm, &nb_bytes_written);
 
-	uint8_t * data_out=malloc(nb_samples_output/8*sizeof(uint8_t));
-	if(!data_out)
-		err(1, "malloc for output data failed");
+		if(fclose(out))
+			err(1, "writing output file %s failed", output_file_name);
+		if(fd_in!=STDIN_FILENO)
+			close(fd_in);
 
-	if(fread(data, sizeof(int16_t), nb_samples, inp)!=nb_samples)
-		err(1, "reading audio data from %s failed", input_file_name);
+		printf("%llu samples converted, %llu bytes written.\n\n", (unsigned long long)nb_samples, (unsigned long long)nb_bytes_written);
 
-	fclose(inp);
+		return 0;
+	}
 
-	FILE * out=fopen(output_file_name, "wb");
-	if(!out)
-		err(1, "creating output file %s failed", output_file_name);
-	
-	int32_t integrator1=0, integrator2=0;
-	int16_t sample;
-	int16_t output=0;
+	if(!strcmp(input_file_name, "-"))
+		errx(1, "reading from stdin needs --raw-in");
 
-	uint8_t packed=0;
-	uint8_t bitcount=0;
+	uint16_t sample_rate;
+	uint32_t nb_samples;
+	int16_t const * data=map_wav(input_file_name, &nb_samples, &sample_rate);
 
-	printf("converting data and writing output file..."); fflush(stdout);
+	printf("Input file contains %u bytes or %u samples of audio data at sampling rate %ukHz.\n", nb_samples*2, nb_samples, sample_rate/1000);
 
-	uint32_t index_in, counter_in, counter_out, index_out;
-	for(index_in=0,counter_in=0,counter_out=0,index_out=0; counter_out<(2*oversampling_ratio*nb_samples+sample_rate*oversampling_ratio); counter_in++,counter_out++)
+	if(nb_osr>1)
 	{
-		//wait for sample_rate*oversampling_ratio output samples before starting the actual conversion to remove nasty audio glitch at the beginning of created file
-		if(counter_out>sample_rate*oversampling_ratio)
-		{
-			sample=data[index_in];
-			if(counter_in>=2*oversampling_ratio)
-			{
-				counter_in=0;
-				index_in++;
-			}
-		}
-		else
-			sample=0;
+		printf("\n");
+		int ret=convert_multi(data, nb_samples, sample_rate, output_file_name, osrs, nb_osr, output_pcm8, output_compressed, with_header, direct_output, f_cpu, cache_dir, loop_start);
+		unmap_wav(data, nb_samples);
+		return ret;
+	}
 
-		integrator2+=integrator1;
+	if(auto_select_osr)
+	{
+		uint8_t format=AUTO_PLAIN;
+		if(!auto_select(data, nb_samples, sample_rate, f_cpu, auto_budget, auto_min_snr, auto_formats, &oversampling_ratio, &format))
+			errx(1, "no OSR and format fit the budget and reach the SNR");
+		output_pcm8=(format==AUTO_PCM8);
+		output_compressed=(format==AUTO_COMPRESSED);
+		printf("Using OSR %u with %s output%s.\n\n", oversampling_ratio, output_pcm8?"PCM8":(output_compressed?"compressed":"plain PDM"), output_pcm8?", the firmware needs PCM_MODE":(output_compressed?", the firmware needs COMPRESSED":""));
+	}
 
-		if(integrator2>0)
-			output=-32768;
-		else
-			output=32767;
+	if((uint64_t)2*oversampling_ratio*nb_samples>UINT32_MAX-7)
+		errx(1, "input file is too long for this OSR");
 
-		integrator1+=((int32_t)sample-output);
+	loop_t loop;
+	if(loop_start!=LOOP_NONE)
+	{
+		char const * error=loop_init(&loop, loop_start, nb_samples, oversampling_ratio, output_pcm8);
+		if(error)
+			errx(1, "%s", error);
+		printf("Loop from sample %u to the end of the input, written %u time(s) with %u samples of silence added before the input (the loop must start and end at a sector boundary).\n", loop_start, loop.nb_copies, loop.nb_silence);
+	}
 
-		integrator2-=(int32_t)output;
+	uint32_t nb_samples_output=2*oversampling_ratio*((loop_start!=LOOP_NONE)?loop.nb_samples:nb_samples);
+	uint32_t nb_bytes_output=(nb_samples_output+7)/8;
 
-		//second part to avoid nasty audio glitch
-		if(counter_out<sample_rate*oversampling_ratio)
-			continue;
+	printf("Output file will contain %u samples and be about %.3fMB or %u sectors (512B each).\n\n", nb_samples_output, (float)nb_bytes_output/1024/1024, nb_bytes_output/512);
 
-		packed<<=1;
+	float ubbr_value_float;
+	uint16_t ubbr_value;
+	if(!calc_ubbr(f_cpu, sample_rate, oversampling_ratio, &ubbr_value_float, &ubbr_value))
+		errx(1, "this OSR can't be done with a %uHz clock", f_cpu);
 
-		packed|=(output>0?1:0);
+	printf("AVR configuration assuming a %.3fMHz clock: UBBR %.2f -> %u\n\n", f_cpu/1E6, ubbr_value_float, ubbr_value);
 
-		bitcount++;
+	uint64_t cache_key=0;
+	if(cache_dir)
+	{
+		if(stdout_data || !prepare_output(output_file_name))
+			errx(1, "--cache needs a regular output file");
 
-		if(bitcount==8)
+		uint8_t codec=output_pcm8?PDM_HEADER_CODEC_PCM8:(output_compressed?PDM_HEADER_CODEC_HUFFMAN:PDM_HEADER_CODEC_NONE);
+		cache_key=cache_hash_pcm(cache_key_start(oversampling_ratio, codec, with_header, f_cpu, sample_rate, nb_samples, loop_start), data, nb_samples);
+		if(cache_fetch(cache_dir, cache_key, output_file_name))
 		{
-			data_out[index_out++]=packed;
-			bitcount=0;
-			packed=0;
+			unmap_wav(data, nb_samples);
+			printf("Output file taken from cache %s, nothing to convert.\n\n", cache_dir);
+			return 0;
 		}
 	}
 
-	if(fwrite(data_out, sizeof(uint8_t), nb_bytes_output, out)!=nb_bytes_output)
-		err(1, "writing output file %s failed", output_file_name);
+	printf("converting data and writing output file..."); fflush(stdout);
 
-	fclose(out);
+	if(output_compressed)
+		codec_build_codes();
 
-	free(data);
-	free(data_out);
+	stream_t stream;
+	write_output(data, nb_samples, sample_rate, output_file_name, stdout_data?fileno(stdout_data):-1, direct_output, oversampling_ratio, output_pcm8, output_compressed, with_header, f_cpu, ubbr_value, (loop_start!=LOOP_NONE)?&loop:NULL, &stream);
+	if(stdout_data)
+		fclose(stdout_data);
+
+	if(cache_dir)
+		cache_store(cache_dir, cache_key, output_file_name);
+
+	unmap_wav(data, nb_samples);
+
+	if(loop_start!=LOOP_NONE)
+		printf(" the loop is sectors %u to %u of the data,", loop.start_sector, loop.end_sector);
+
+	if(output_pcm8)
+	{
+		printf(" all done!\n\nPCM output file contains %llu sectors (512B each)%s. Set PCM_MODE to 1%s in the firmware.\n\n", (unsigned long long)stream.nb_bytes/512, with_header?" plus the header":"", with_header?"":" and OSR to the same value");
+		return 0;
+	}
+
+	if(output_compressed && nb_bytes_output)
+		printf(" compressed to %.1f%% (%u of %u blocks stored uncompressed), %llu sectors.", 100.0*stream.nb_bytes/nb_bytes_output, stream.nb_blocks_stored, stream.nb_blocks, (unsigned long long)stream.nb_bytes/512);
 
 	printf(" all done!\n\n");
 
-	printf("Copy output file to SD-card (as a file or an image).\nDon't forget adjusting UBBR, file name and size for raw-access inside your code.\n\n");
+	if(with_header)
+		printf("Copy output file to SD-card (as a file or an image).\nThe firmware takes UBBR and size from the header, don't forget adjusting the file name if needed.\n\n");
+	else
+		printf("Copy output file to SD-card (as a file or an image).\nDon't forget adjusting UBBR, file name and size for raw-access inside your code.\n\n");
 
 	return 0;
 }
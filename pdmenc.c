@@ -0,0 +1,164 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "pdmenc.h"
+
+/*
+This file is part of mega328-pdm-audio (c) 2022 by kittennbfive.
+
+AGPLv3+ and NO WARRANTY!
+
+Please read the fine manual!
+
+Second-order modulator (AoE3 figure 13.55), see pdmenc.h for how to use it.
+*/
+
+#define INTEGRATOR_LIMIT (1LL<<24) //never reached with sane input, only keeps an overloaded modulator from running away
+
+//with silence the modulator runs the idle cycle 1001, this is a state on it: where 64 steps of silence from 0 end, after the start-up transient
+//starting here is the same as modulating silence for a while first, without spending the time
+#define SETTLED_INTEGRATOR1 32
+#define SETTLED_INTEGRATOR2 1040
+
+#if PDMENC_BUFFER_SIZE&(PDMENC_BUFFER_SIZE-1)
+#error PDMENC_BUFFER_SIZE must be a power of 2
+#endif
+
+static inline int64_t saturate(const int64_t value)
+{
+	if(value>INTEGRATOR_LIMIT)
+		return INTEGRATOR_LIMIT;
+	if(value<-INTEGRATOR_LIMIT)
+		return -INTEGRATOR_LIMIT;
+	return value;
+}
+
+//the integrators are saturated once per input sample, in between they can't grow beyond about 2^35 in 510 steps, so int64_t never overflows and the result is the same for any optimisation of any compiler
+//the state is copied to local variables so the compiler can keep it in registers while writing the buffer
+static void modulate_samples(pdmenc_t * const enc, int16_t const * const pcm, const uint32_t nb_samples)
+{
+	int64_t integrator1=enc->integrator1, integrator2=enc->integrator2;
+	int64_t positive, output;
+	uint8_t packed=enc->packed;
+	uint8_t bitcount=enc->bitcount;
+	uint16_t write_index=(enc->read_index+enc->nb_bytes)&(PDMENC_BUFFER_SIZE-1);
+	uint16_t nb_bytes=enc->nb_bytes;
+	const uint16_t nb_bits=2*enc->oversampling_ratio;
+	uint32_t index_in;
+	uint16_t bit;
+
+	for(index_in=0; index_in<nb_samples; index_in++)
+	{
+		const int64_t sample=pcm[index_in];
+
+		//each input sample lasts exactly 2*oversampling_ratio output samples
+		for(bit=0; bit<nb_bits; bit++)
+		{
+			integrator2+=integrator1;
+
+			//32767 or -32768 without a branch, the decision is random and would be mispredicted half of the time
+			positive=(integrator2>0);
+			output=positive*65535-32768;
+
+			integrator1+=sample-output;
+
+			integrator2-=output;
+
+			packed<<=1;
+
+			packed|=positive;
+
+			bitcount++;
+
+			if(bitcount==8)
+			{
+				enc->buffer[write_index]=packed;
+				write_index=(write_index+1)&(PDMENC_BUFFER_SIZE-1);
+				nb_bytes++;
+				bitcount=0;
+				packed=0;
+			}
+		}
+
+		integrator1=saturate(integrator1);
+		integrator2=saturate(integrator2);
+	}
+
+	enc->integrator1=integrator1;
+	enc->integrator2=integrator2;
+	enc->packed=packed;
+	enc->bitcount=bitcount;
+	enc->nb_bytes=nb_bytes;
+}
+
+bool pdmenc_init(pdmenc_t * const enc, const uint8_t oversampling_ratio)
+{
+	if(oversampling_ratio==0)
+		return false;
+
+	memset(enc, 0, sizeof(pdmenc_t));
+	enc->oversampling_ratio=oversampling_ratio;
+	enc->integrator1=SETTLED_INTEGRATOR1;
+	enc->integrator2=SETTLED_INTEGRATOR2;
+
+	return true;
+}
+
+uint32_t pdmenc_push_pcm(pdmenc_t * const enc, int16_t const * const pcm, const uint32_t nb_samples)
+{
+	uint32_t nb_free_bytes=PDMENC_BUFFER_SIZE-enc->nb_bytes;
+	if(nb_free_bytes<PDMENC_MAX_BYTES_PER_SAMPLE)
+		return 0;
+
+	uint32_t nb=(nb_free_bytes-PDMENC_MAX_BYTES_PER_SAMPLE)*8/(2*enc->oversampling_ratio)+1;
+	if(nb>nb_samples)
+		nb=nb_samples;
+
+	modulate_samples(enc, pcm, nb);
+
+	return nb;
+}
+
+uint32_t pdmenc_pull_packed(pdmenc_t * const enc, uint8_t * const out, const uint32_t max_bytes)
+{
+	uint32_t nb=enc->nb_bytes;
+	if(nb>max_bytes)
+		nb=max_bytes;
+
+	//in up to 2 pieces because of the wrap-around
+	uint32_t first=PDMENC_BUFFER_SIZE-enc->read_index;
+	if(first>nb)
+		first=nb;
+	memcpy(out, &enc->buffer[enc->read_index], first);
+	memcpy(out+first, enc->buffer, nb-first);
+
+	enc->read_index=(enc->read_index+nb)&(PDMENC_BUFFER_SIZE-1);
+	enc->nb_bytes-=nb;
+
+	return nb;
+}
+
+void pdmenc_flush(pdmenc_t * const enc)
+{
+	//silence bit by bit until the byte is complete, push_pcm left room for this byte
+	while(enc->bitcount)
+	{
+		enc->integrator2+=enc->integrator1;
+		int64_t positive=(enc->integrator2>0);
+		int64_t output=positive*65535-32768;
+		enc->integrator1-=output;
+		enc->integrator2-=output;
+
+		enc->packed=(enc->packed<<1)|positive;
+		enc->bitcount++;
+
+		if(enc->bitcount==8)
+		{
+			enc->buffer[(enc->read_index+enc->nb_bytes)&(PDMENC_BUFFER_SIZE-1)]=enc->packed;
+			enc->nb_bytes++;
+			enc->bitcount=0;
+			enc->packed=0;
+		}
+	}
+}
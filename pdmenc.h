@@ -0,0 +1,59 @@
+#ifndef __PDMENC_H__
+#define __PDMENC_H__
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+This file is part of mega328-pdm-audio (c) 2022 by kittennbfive.
+
+AGPLv3+ and NO WARRANTY!
+
+Please read the fine manual!
+
+Streaming encoder for packed PDM-data, the second-order modulator of pdmconv as a library. Push 16 bit signed PCM, pull packed PDM-data (MSB first, 2*oversampling_ratio bits per sample), in blocks of any size. The encoder keeps the modulator state across calls and never allocates memory, a pdmenc_t can live on the stack or be static.
+
+Usage:
+	pdmenc_t enc;
+	pdmenc_init(&enc, osr);
+	while(more PCM)
+	{
+		n=pdmenc_push_pcm(&enc, pcm, nb_samples); //takes as many samples as fit, push the rest after pulling
+		pdmenc_pull_packed(&enc, out, sizeof(out)); //returns the number of bytes
+	}
+	pdmenc_flush(&enc); //completes the last byte
+	pdmenc_pull_packed(&enc, out, sizeof(out));
+
+The output is the same as pdmconv writes (without header), whatever the block sizes are.
+*/
+
+#define PDMENC_BUFFER_SIZE 4096 //bytes of packed PDM-data held until pulled, must be a power of 2
+#define PDMENC_MAX_BYTES_PER_SAMPLE ((2*255+7)/8+1) //worst case, OSR 255 and a partial byte before
+
+typedef struct
+{
+	//modulator
+	int64_t integrator1;
+	int64_t integrator2;
+	uint8_t packed;
+	uint8_t bitcount;
+	uint8_t oversampling_ratio;
+
+	//packed PDM-data not pulled yet
+	uint8_t buffer[PDMENC_BUFFER_SIZE];
+	uint16_t read_index;
+	uint16_t nb_bytes;
+} pdmenc_t;
+
+//false if the oversampling_ratio is 0, the modulator starts settled as if it had been modulating silence
+bool pdmenc_init(pdmenc_t * const enc, const uint8_t oversampling_ratio);
+
+//returns the number of samples taken, less than nb_samples if the buffer is full
+uint32_t pdmenc_push_pcm(pdmenc_t * const enc, int16_t const * const pcm, const uint32_t nb_samples);
+
+//returns the number of bytes copied to out
+uint32_t pdmenc_pull_packed(pdmenc_t * const enc, uint8_t * const out, const uint32_t max_bytes);
+
+//completes a partial last byte with silence, pull it afterwards
+void pdmenc_flush(pdmenc_t * const enc);
+
+#endif
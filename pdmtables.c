@@ -0,0 +1,389 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <err.h>
+
+/*
+This tool generates pdm_codec.h, the static tables of the block codec used by pdmconv --compress and the firmware, from some sample PDM-files made with pdmconv.
+
+(c) 2022 by kittennbfive
+
+AGPLv3+ and NO WARRANTY!
+
+Please read the documentation!
+
+The context of a byte is the previous byte of the same block. The 256 contexts are grouped into PDM_CODEC_NB_TABLES clusters with similar statistics (k-means), each cluster gets its own canonical Huffman code limited to PDM_CODEC_MAX_CODE_LENGTH bits.
+
+After changing the tables every compressed file must be converted again!
+
+usage: pdmtables pdm_codec.h file1.pdm [file2.pdm ...]
+*/
+
+#define BLOCK_SIZE 512
+#define NB_TABLES 16
+#define MAX_CODE_LENGTH 12
+#define LUT_BITS 8
+#define NB_KMEANS_ITERATIONS 10
+
+static uint64_t freq[256][256]; //[context][symbol]
+static uint64_t freq_cluster[NB_TABLES][256];
+static uint8_t cluster_of_context[256];
+static uint8_t length[NB_TABLES][256];
+
+static double cost_context_in_cluster(const uint8_t context, const uint8_t cluster)
+{
+	uint64_t total=256;
+	uint16_t s;
+	for(s=0; s<256; s++)
+		total+=freq_cluster[cluster][s];
+
+	double cost=0;
+	for(s=0; s<256; s++)
+	{
+		if(freq[context][s])
+			cost-=freq[context][s]*log2((double)(freq_cluster[cluster][s]+1)/total);
+	}
+
+	return cost;
+}
+
+static void update_clusters(void)
+{
+	memset(freq_cluster, 0, sizeof(freq_cluster));
+	uint16_t c, s;
+	for(c=0; c<256; c++)
+	{
+		for(s=0; s<256; s++)
+			freq_cluster[cluster_of_context[c]][s]+=freq[c][s];
+	}
+}
+
+static void build_clusters(void)
+{
+	//start with the most frequent contexts as centers, everything else goes to the last cluster
+	uint8_t used[256]={0};
+	uint16_t c, s;
+	uint8_t k;
+	for(k=0; k<NB_TABLES; k++)
+	{
+		uint64_t best_total=0;
+		uint16_t best=0;
+		for(c=0; c<256; c++)
+		{
+			if(used[c])
+				continue;
+			uint64_t total=0;
+			for(s=0; s<256; s++)
+				total+=freq[c][s];
+			if(total>=best_total)
+			{
+				best_total=total;
+				best=c;
+			}
+		}
+		used[best]=1;
+		memcpy(freq_cluster[k], freq[best], sizeof(freq_cluster[k]));
+	}
+
+	uint8_t it;
+	for(it=0; it<NB_KMEANS_ITERATIONS; it++)
+	{
+		for(c=0; c<256; c++)
+		{
+			double best_cost=INFINITY;
+			for(k=0; k<NB_TABLES; k++)
+			{
+				double cost=cost_context_in_cluster(c, k);
+				if(cost<best_cost)
+				{
+					best_cost=cost;
+					cluster_of_context[c]=k;
+				}
+			}
+		}
+		update_clusters();
+	}
+}
+
+static void build_lengths(const uint8_t cluster)
+{
+	//plain Huffman on freq+1 (so every symbol gets a code), then limit the length and repair the Kraft sum
+	uint64_t weight[512];
+	int16_t parent[512];
+	bool done[512];
+	uint16_t nb_nodes=256;
+	uint16_t i;
+
+	for(i=0; i<256; i++)
+		weight[i]=freq_cluster[cluster][i]+1;
+	for(i=0; i<512; i++)
+	{
+		parent[i]=-1;
+		done[i]=false;
+	}
+
+	while(1)
+	{
+		int16_t a=-1, b=-1;
+		for(i=0; i<nb_nodes; i++)
+		{
+			if(done[i])
+				continue;
+			if(a<0 || weight[i]<weight[a])
+			{
+				b=a;
+				a=i;
+			}
+			else if(b<0 || weight[i]<weight[b])
+				b=i;
+		}
+		if(b<0)
+			break;
+		weight[nb_nodes]=weight[a]+weight[b];
+		parent[a]=nb_nodes;
+		parent[b]=nb_nodes;
+		done[a]=true;
+		done[b]=true;
+		nb_nodes++;
+	}
+
+	for(i=0; i<256; i++)
+	{
+		uint8_t len=0;
+		int16_t n=i;
+		while(parent[n]>=0)
+		{
+			n=parent[n];
+			len++;
+		}
+		length[cluster][i]=(len>MAX_CODE_LENGTH)?MAX_CODE_LENGTH:len;
+	}
+
+	//Kraft sum in units of 2^-MAX_CODE_LENGTH
+	uint32_t kraft=0;
+	for(i=0; i<256; i++)
+		kraft+=1<<(MAX_CODE_LENGTH-length[cluster][i]);
+
+	while(kraft>(1<<MAX_CODE_LENGTH))
+	{
+		//make the rarest symbol among the longest codes below the limit one bit longer
+		int16_t worst=-1;
+		for(i=0; i<256; i++)
+		{
+			if(length[cluster][i]==MAX_CODE_LENGTH)
+				continue;
+			if(worst<0 || length[cluster][i]>length[cluster][worst] || (length[cluster][i]==length[cluster][worst] && freq_cluster[cluster][i]<freq_cluster[cluster][worst]))
+				worst=i;
+		}
+		kraft-=1<<(MAX_CODE_LENGTH-length[cluster][worst]-1);
+		length[cluster][worst]++;
+	}
+}
+
+//canonical code: sorted by length, then by symbol
+static uint16_t sort_symbols(const uint8_t cluster, uint8_t * const sorted)
+{
+	uint16_t nb=0;
+	uint8_t len;
+	uint16_t s;
+	for(len=1; len<=MAX_CODE_LENGTH; len++)
+	{
+		for(s=0; s<256; s++)
+		{
+			if(length[cluster][s]==len)
+				sorted[nb++]=s;
+		}
+	}
+	return nb;
+}
+
+static void print_array_u8(FILE * const f, uint8_t const * const data, const uint16_t nb)
+{
+	uint16_t i;
+	for(i=0; i<nb; i++)
+		fprintf(f, "%s%u%s", (i%16)?"":"\t\t", data[i], (i==nb-1)?"\n":((i%16==15)?",\n":","));
+}
+
+int main(int argc, char **argv)
+{
+	if(argc<3)
+		errx(1, "usage: pdmtables pdm_codec.h file1.pdm [file2.pdm ...]");
+
+	uint64_t nb_bytes=0;
+	int i;
+	for(i=2; i<argc; i++)
+	{
+		FILE * inp=fopen(argv[i], "rb");
+		if(!inp)
+			err(1, "opening %s failed", argv[i]);
+		uint8_t block[BLOCK_SIZE];
+		size_t n;
+		while((n=fread(block, 1, BLOCK_SIZE, inp))>0)
+		{
+			uint8_t previous=0;
+			size_t j;
+			for(j=0; j<n; j++)
+			{
+				freq[previous][block[j]]++;
+				previous=block[j];
+			}
+			nb_bytes+=n;
+		}
+		fclose(inp);
+	}
+
+	printf("training on %lu bytes\n", (unsigned long)nb_bytes);
+
+	build_clusters();
+
+	uint8_t k;
+	double bits=0;
+	for(k=0; k<NB_TABLES; k++)
+	{
+		build_lengths(k);
+		uint16_t s;
+		for(s=0; s<256; s++)
+			bits+=(double)freq_cluster[k][s]*length[k][s];
+	}
+
+	printf("compressed size on training data: %.1f%%\n", 100*bits/8/nb_bytes);
+
+	//decoder tables
+	uint8_t lut_len[NB_TABLES][1<<LUT_BITS];
+	uint8_t lut_sym[NB_TABLES][1<<LUT_BITS];
+	uint16_t long_first[NB_TABLES][MAX_CODE_LENGTH-LUT_BITS];
+	uint16_t long_index[NB_TABLES][MAX_CODE_LENGTH-LUT_BITS];
+	uint8_t long_count[NB_TABLES][MAX_CODE_LENGTH-LUT_BITS];
+	uint8_t long_symbols[NB_TABLES*256];
+	uint16_t nb_long_symbols=0;
+
+	memset(lut_len, 0, sizeof(lut_len));
+	memset(lut_sym, 0, sizeof(lut_sym));
+	memset(long_first, 0, sizeof(long_first));
+	memset(long_index, 0, sizeof(long_index));
+	memset(long_count, 0, sizeof(long_count));
+
+	for(k=0; k<NB_TABLES; k++)
+	{
+		uint8_t sorted[256];
+		uint16_t nb=sort_symbols(k, sorted);
+		uint16_t code=0;
+		uint8_t previous_len=0;
+		uint16_t j;
+		for(j=0; j<nb; j++)
+		{
+			uint8_t s=sorted[j];
+			uint8_t len=length[k][s];
+			if(j)
+				code++;
+			code<<=(len-previous_len);
+			previous_len=len;
+
+			if(len<=LUT_BITS)
+			{
+				uint16_t first=code<<(LUT_BITS-len);
+				uint16_t e;
+				for(e=0; e<(1U<<(LUT_BITS-len)); e++)
+				{
+					lut_len[k][first+e]=len;
+					lut_sym[k][first+e]=s;
+				}
+			}
+			else
+			{
+				uint8_t l=len-LUT_BITS-1;
+				if(long_count[k][l]==0)
+				{
+					long_first[k][l]=code;
+					long_index[k][l]=nb_long_symbols;
+				}
+				long_count[k][l]++;
+				long_symbols[nb_long_symbols++]=s;
+			}
+		}
+	}
+
+	FILE * out=fopen(argv[1], "w");
+	if(!out)
+		err(1, "creating %s failed", argv[1]);
+
+	fprintf(out, "#ifndef __PDM_CODEC_H__\n#define __PDM_CODEC_H__\n#include <stdint.h>\n\n");
+	fprintf(out, "/*\nThis file is part of mega328-pdm-audio (c) 2022 by kittennbfive.\n\nAGPLv3+ and NO WARRANTY!\n\nGENERATED BY pdmtables FROM %lu BYTES OF SAMPLE DATA - DO NOT EDIT!\nAll copies of this file (pdmconv and both firmwares) must be identical.\n\n", (unsigned long)nb_bytes);
+	fprintf(out, "Format of a compressed file: a stream of blocks, each decoding to PDM_CODEC_BLOCK_SIZE bytes of PDM-data. A block starts with a little endian uint16_t:\n");
+	fprintf(out, "- PDM_CODEC_END: end of data, the rest of the file is padding\n- PDM_CODEC_STORED: PDM_CODEC_BLOCK_SIZE bytes of uncompressed data follow\n- else the number of bytes of Huffman-coded data that follow\n\n");
+	fprintf(out, "Huffman-coded data is read MSB first. The table for a byte is pdm_codec_table_of_context[previous byte of the block] (0 for the first byte).\n");
+	fprintf(out, "A decoder looks at the next PDM_CODEC_LUT_BITS bits: if pdm_codec_lut_len!=0 the symbol is complete, else it appends single bits until for length l the code minus pdm_codec_long_first is smaller than pdm_codec_long_count. That takes at most PDM_CODEC_MAX_CODE_LENGTH-PDM_CODEC_LUT_BITS steps.\n*/\n\n");
+
+	fprintf(out, "#ifndef PROGMEM\n#define PROGMEM\n#endif\n\n");
+	fprintf(out, "#define PDM_CODEC_BLOCK_SIZE %u\n#define PDM_CODEC_END 0x0000\n#define PDM_CODEC_STORED 0x8000\n#define PDM_CODEC_NB_TABLES %u\n#define PDM_CODEC_MAX_CODE_LENGTH %u\n#define PDM_CODEC_LUT_BITS %u\n\n", BLOCK_SIZE, NB_TABLES, MAX_CODE_LENGTH, LUT_BITS);
+
+	fprintf(out, "static const uint8_t pdm_codec_table_of_context[256] PROGMEM=\n{\n");
+	print_array_u8(out, cluster_of_context, 256);
+	fprintf(out, "};\n\n");
+
+	fprintf(out, "#if PDM_CODEC_ENCODER\n//code length of each symbol, the encoder builds the canonical codes from this\nstatic const uint8_t pdm_codec_length[PDM_CODEC_NB_TABLES][256]=\n{\n");
+	for(k=0; k<NB_TABLES; k++)
+	{
+		fprintf(out, "\t{\n");
+		print_array_u8(out, length[k], 256);
+		fprintf(out, "\t}%s\n", (k==NB_TABLES-1)?"":",");
+	}
+	fprintf(out, "};\n#endif\n\n");
+
+	fprintf(out, "#if PDM_CODEC_DECODER\nstatic const uint8_t pdm_codec_lut_len[PDM_CODEC_NB_TABLES][1<<PDM_CODEC_LUT_BITS] PROGMEM=\n{\n");
+	for(k=0; k<NB_TABLES; k++)
+	{
+		fprintf(out, "\t{\n");
+		print_array_u8(out, lut_len[k], 1<<LUT_BITS);
+		fprintf(out, "\t}%s\n", (k==NB_TABLES-1)?"":",");
+	}
+	fprintf(out, "};\n\nstatic const uint8_t pdm_codec_lut_sym[PDM_CODEC_NB_TABLES][1<<PDM_CODEC_LUT_BITS] PROGMEM=\n{\n");
+	for(k=0; k<NB_TABLES; k++)
+	{
+		fprintf(out, "\t{\n");
+		print_array_u8(out, lut_sym[k], 1<<LUT_BITS);
+		fprintf(out, "\t}%s\n", (k==NB_TABLES-1)?"":",");
+	}
+	fprintf(out, "};\n\n//[table][length-PDM_CODEC_LUT_BITS-1]\nstatic const uint16_t pdm_codec_long_first[PDM_CODEC_NB_TABLES][PDM_CODEC_MAX_CODE_LENGTH-PDM_CODEC_LUT_BITS] PROGMEM=\n{\n");
+	for(k=0; k<NB_TABLES; k++)
+	{
+		fprintf(out, "\t{ ");
+		uint8_t l;
+		for(l=0; l<MAX_CODE_LENGTH-LUT_BITS; l++)
+			fprintf(out, "%u%s", long_first[k][l], (l==MAX_CODE_LENGTH-LUT_BITS-1)?"":", ");
+		fprintf(out, " }%s\n", (k==NB_TABLES-1)?"":",");
+	}
+	fprintf(out, "};\n\nstatic const uint16_t pdm_codec_long_index[PDM_CODEC_NB_TABLES][PDM_CODEC_MAX_CODE_LENGTH-PDM_CODEC_LUT_BITS] PROGMEM=\n{\n");
+	for(k=0; k<NB_TABLES; k++)
+	{
+		fprintf(out, "\t{ ");
+		uint8_t l;
+		for(l=0; l<MAX_CODE_LENGTH-LUT_BITS; l++)
+			fprintf(out, "%u%s", long_index[k][l], (l==MAX_CODE_LENGTH-LUT_BITS-1)?"":", ");
+		fprintf(out, " }%s\n", (k==NB_TABLES-1)?"":",");
+	}
+	fprintf(out, "};\n\nstatic const uint8_t pdm_codec_long_count[PDM_CODEC_NB_TABLES][PDM_CODEC_MAX_CODE_LENGTH-PDM_CODEC_LUT_BITS] PROGMEM=\n{\n");
+	for(k=0; k<NB_TABLES; k++)
+	{
+		fprintf(out, "\t{ ");
+		uint8_t l;
+		for(l=0; l<MAX_CODE_LENGTH-LUT_BITS; l++)
+			fprintf(out, "%u%s", long_count[k][l], (l==MAX_CODE_LENGTH-LUT_BITS-1)?"":", ");
+		fprintf(out, " }%s\n", (k==NB_TABLES-1)?"":",");
+	}
+	fprintf(out, "};\n\nstatic const uint8_t pdm_codec_long_symbols[%u] PROGMEM=\n{\n", nb_long_symbols?nb_long_symbols:1);
+	if(nb_long_symbols)
+		print_array_u8(out, long_symbols, nb_long_symbols);
+	else
+		fprintf(out, "\t\t0\n");
+	fprintf(out, "};\n#endif\n\n#endif\n");
+
+	fclose(out);
+
+	printf("%s written, %u symbols with long codes\n", argv[1], nb_long_symbols);
+
+	return 0;
+}
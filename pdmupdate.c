@@ -0,0 +1,400 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <err.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <limits.h>
+
+/*
+This tool updates a card (or any image) that already contains an older version of an image, writing only the 512 byte sectors that changed. Changed sectors close to each other are merged into bigger runs, every run is read back and compared after writing.
+The old content is taken from the old image, from a manifest (a hash per sector) saved by a previous run or from the card itself.
+
+(c) 2022 by kittennbfive
+
+AGPLv3+ and NO WARRANTY!
+
+Please read the documentation!
+
+compile: gcc -Wall -Wextra -Werror -O2 -o pdmupdate pdmupdate.c
+*/
+
+#define SECTOR_SIZE 512
+#define CHUNK_SECTORS 2048 //compared at once, 1MB
+#define RUN_MAX_SECTORS 2048 //longest write, 1MB
+#define DEFAULT_GAP_SECTORS 16 //unchanged sectors between two changes that are written anyway to save a command
+
+#define MANIFEST_MAGIC "kPDMMAN1"
+
+//FNV-1a 64 bit
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+typedef struct __attribute__((__packed__))
+{
+	char magic[8]; //MANIFEST_MAGIC, no terminating 0
+	uint64_t nb_sectors;
+	//followed by one uint64_t hash per sector
+} manifest_header_t;
+
+typedef struct
+{
+	uint64_t first;
+	uint32_t nb;
+} run_t;
+
+static void print_usage_and_exit(void)
+{
+	printf("usage: pdmupdate [--old old.img | --manifest old.manifest] [--save-manifest new.manifest] [--gap $sectors] [--dry-run] new.img target\n\nWrites only the sectors of new.img that differ from what is on target (a card like /dev/sdX or an image file) and reads them back to verify.\n--old takes the old content from the image that was written last time, --manifest from a manifest saved by --save-manifest. Without both the whole target is read and compared.\n--save-manifest writes a hash of every sector of new.img for the next update, only after everything was written and verified (it can be the same file as --manifest).\n$gap unchanged sectors (default %u) between two changes are written too so the writes are bigger and fewer.\n--dry-run only prints what would be written.\nWarning: The target is overwritten without asking, check its name twice!\n\n", DEFAULT_GAP_SECTORS);
+	exit(0);
+}
+
+static uint64_t hash_sector(uint8_t const * const data)
+{
+	uint64_t hash=FNV_OFFSET;
+	uint16_t i;
+	for(i=0; i<SECTOR_SIZE; i++)
+	{
+		hash^=data[i];
+		hash*=FNV_PRIME;
+	}
+	return hash;
+}
+
+static double now(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec+t.tv_nsec/1E9;
+}
+
+//reads up to nb_bytes, less only at the end of the file
+static size_t read_at(const int fd, void * const data, const size_t nb_bytes, const uint64_t offset, char const * const name)
+{
+	size_t nb_read=0;
+	while(nb_read<nb_bytes)
+	{
+		ssize_t n=pread(fd, (uint8_t*)data+nb_read, nb_bytes-nb_read, offset+nb_read);
+		if(n<0 && errno==EINTR)
+			continue;
+		if(n<0)
+			err(1, "reading %s failed", name);
+		if(n==0)
+			break;
+		nb_read+=n;
+	}
+	return nb_read;
+}
+
+static void write_at(const int fd, void const * const data, const size_t nb_bytes, const uint64_t offset, char const * const name)
+{
+	size_t nb_written=0;
+	while(nb_written<nb_bytes)
+	{
+		ssize_t n=pwrite(fd, (uint8_t const *)data+nb_written, nb_bytes-nb_written, offset+nb_written);
+		if(n<0 && errno==EINTR)
+			continue;
+		if(n<=0)
+			err(1, "writing %s failed", name);
+		nb_written+=n;
+	}
+}
+
+static uint64_t size_of(const int fd, char const * const name)
+{
+	struct stat st;
+	if(fstat(fd, &st))
+		err(1, "stat of %s failed", name);
+	if(S_ISREG(st.st_mode))
+		return st.st_size;
+
+	//block device
+	off_t size=lseek(fd, 0, SEEK_END);
+	if(size<0)
+		err(1, "getting size of %s failed", name);
+	return size;
+}
+
+static void add_changed_sector(run_t ** const runs, uint32_t * const nb_runs, uint32_t * const nb_allocated, const uint64_t sector, const uint32_t gap)
+{
+	if(*nb_runs)
+	{
+		run_t * last=&(*runs)[(*nb_runs)-1];
+		uint64_t end=last->first+last->nb;
+		if(sector-end<=gap && sector+1-last->first<=RUN_MAX_SECTORS)
+		{
+			last->nb=sector+1-last->first;
+			return;
+		}
+	}
+
+	if((*nb_runs)==(*nb_allocated))
+	{
+		(*nb_allocated)=(*nb_allocated)?2*(*nb_allocated):256;
+		(*runs)=realloc(*runs, (*nb_allocated)*sizeof(run_t));
+		if(!(*runs))
+			err(1, "malloc for list of changes failed");
+	}
+	(*runs)[*nb_runs].first=sector;
+	(*runs)[*nb_runs].nb=1;
+	(*nb_runs)++;
+}
+
+//the new manifest is written to a temporary file that replaces the real one only after the card was written and verified, it is removed if anything fails before
+static char save_manifest_tmp[PATH_MAX];
+
+static void remove_unfinished_manifest(void)
+{
+	if(save_manifest_tmp[0])
+		unlink(save_manifest_tmp);
+}
+
+int main(int argc, char **argv)
+{
+	const struct option optiontable[]=
+	{
+		{ "old",			required_argument,	NULL,	0 },
+		{ "manifest",		required_argument,	NULL,	1 },
+		{ "save-manifest",	required_argument,	NULL,	2 },
+		{ "gap",			required_argument,	NULL,	3 },
+		{ "dry-run",		no_argument,		NULL,	4 },
+		{ "help",			no_argument,		NULL, 	101 },
+		{ "usage",			no_argument,		NULL, 	101 },
+		{ NULL, 0, NULL, 0 }
+	};
+
+	int optionindex;
+	int opt;
+
+	char const * old_name=NULL;
+	char const * manifest_name=NULL;
+	char const * save_manifest_name=NULL;
+	uint32_t gap=DEFAULT_GAP_SECTORS;
+	bool dry_run=false;
+
+	printf("\nThis is pdmupdate (c) 2022 by kittennbfive\nThis tool is released under AGPLv3+ and comes WITHOUT ANY WARRANTY!\n\n");
+
+	if(argc==1)
+		print_usage_and_exit();
+
+	while((opt=getopt_long(argc, argv, "", optiontable, &optionindex))!=-1)
+	{
+		switch(opt)
+		{
+			case '?': print_usage_and_exit(); break;
+			case 0: old_name=optarg; break;
+			case 1: manifest_name=optarg; break;
+			case 2: save_manifest_name=optarg; break;
+			case 3: gap=atol(optarg); break;
+			case 4: dry_run=true; break;
+			case 101: print_usage_and_exit(); break;
+
+			default: errx(1, "don't know how to handle %d returned by getopt_long", opt); break;
+		}
+	}
+
+	if(argc-optind!=2)
+		errx(1, "missing new image and/or target");
+
+	if(old_name && manifest_name)
+		errx(1, "--old and --manifest can't be used together");
+
+	if(save_manifest_name && dry_run)
+		errx(1, "--save-manifest can't be used with --dry-run, nothing is written to the target");
+
+	char const * const new_name=argv[optind];
+	char const * const target_name=argv[optind+1];
+
+	int fd_new=open(new_name, O_RDONLY);
+	if(fd_new<0)
+		err(1, "opening %s failed", new_name);
+	uint64_t size_new=size_of(fd_new, new_name);
+	if(size_new%SECTOR_SIZE)
+		errx(1, "size of %s is not a multiple of %u", new_name, SECTOR_SIZE);
+	uint64_t nb_sectors=size_new/SECTOR_SIZE;
+
+	int fd_target=open(target_name, dry_run?O_RDONLY:O_RDWR);
+	if(fd_target<0)
+		err(1, "opening %s failed", target_name);
+	if(size_of(fd_target, target_name)<size_new)
+		errx(1, "%s is smaller than %s", target_name, new_name);
+
+	//the old content
+	int fd_old=-1;
+	char const * compare_name=target_name;
+	uint64_t nb_sectors_old=nb_sectors;
+	FILE * manifest=NULL;
+	if(old_name)
+	{
+		fd_old=open(old_name, O_RDONLY);
+		if(fd_old<0)
+			err(1, "opening %s failed", old_name);
+		nb_sectors_old=size_of(fd_old, old_name)/SECTOR_SIZE;
+		compare_name=old_name;
+	}
+	else if(manifest_name)
+	{
+		manifest=fopen(manifest_name, "rb");
+		if(!manifest)
+			err(1, "opening %s failed", manifest_name);
+		manifest_header_t header;
+		if(fread(&header, sizeof(manifest_header_t), 1, manifest)!=1 || memcmp(header.magic, MANIFEST_MAGIC, 8))
+			errx(1, "%s is not a manifest made by pdmupdate", manifest_name);
+		nb_sectors_old=header.nb_sectors;
+		compare_name=manifest_name;
+	}
+	else
+		fd_old=fd_target;
+
+	FILE * save_manifest=NULL;
+	if(save_manifest_name)
+	{
+		if((size_t)snprintf(save_manifest_tmp, sizeof(save_manifest_tmp), "%s.tmp", save_manifest_name)>=sizeof(save_manifest_tmp))
+			errx(1, "name %s is too long", save_manifest_name);
+		save_manifest=fopen(save_manifest_tmp, "wb");
+		if(!save_manifest)
+			err(1, "creating %s failed", save_manifest_tmp);
+		atexit(remove_unfinished_manifest);
+		manifest_header_t header;
+		memcpy(header.magic, MANIFEST_MAGIC, 8);
+		header.nb_sectors=nb_sectors;
+		if(fwrite(&header, sizeof(manifest_header_t), 1, save_manifest)!=1)
+			err(1, "writing %s failed", save_manifest_name);
+	}
+
+	printf("Comparing %s (%llu sectors) with %s...", new_name, (unsigned long long)nb_sectors, compare_name); fflush(stdout);
+
+	uint8_t * chunk_new=malloc(CHUNK_SECTORS*SECTOR_SIZE);
+	uint8_t * chunk_old=malloc(CHUNK_SECTORS*SECTOR_SIZE);
+	uint64_t hashes[CHUNK_SECTORS];
+	if(!chunk_new || !chunk_old)
+		err(1, "malloc for buffers failed");
+
+	run_t * runs=NULL;
+	uint32_t nb_runs=0, nb_allocated=0;
+	uint64_t nb_changed=0;
+
+	double start=now();
+
+	uint64_t sector;
+	for(sector=0; sector<nb_sectors; sector+=CHUNK_SECTORS)
+	{
+		uint32_t nb=(nb_sectors-sector<CHUNK_SECTORS)?nb_sectors-sector:CHUNK_SECTORS;
+		if(read_at(fd_new, chunk_new, nb*SECTOR_SIZE, sector*SECTOR_SIZE, new_name)!=nb*SECTOR_SIZE)
+			errx(1, "%s got shorter while reading", new_name);
+
+		uint32_t nb_old=(sector>=nb_sectors_old)?0:((nb_sectors_old-sector<nb)?nb_sectors_old-sector:nb);
+		if(manifest)
+		{
+			if(fread(hashes, sizeof(uint64_t), nb_old, manifest)!=nb_old)
+				errx(1, "%s is truncated", manifest_name);
+		}
+		else if(nb_old)
+			nb_old=read_at(fd_old, chunk_old, nb_old*SECTOR_SIZE, sector*SECTOR_SIZE, compare_name)/SECTOR_SIZE;
+
+		uint32_t i;
+		for(i=0; i<nb; i++)
+		{
+			uint8_t const * data=&chunk_new[i*SECTOR_SIZE];
+			bool changed;
+			if(i>=nb_old)
+				changed=true;
+			else if(manifest)
+				changed=(hash_sector(data)!=hashes[i]);
+			else
+				changed=memcmp(data, &chunk_old[i*SECTOR_SIZE], SECTOR_SIZE);
+
+			if(save_manifest)
+			{
+				uint64_t hash=hash_sector(data);
+				if(fwrite(&hash, sizeof(uint64_t), 1, save_manifest)!=1)
+					err(1, "writing %s failed", save_manifest_name);
+			}
+
+			if(changed)
+			{
+				nb_changed++;
+				add_changed_sector(&runs, &nb_runs, &nb_allocated, sector+i, gap);
+			}
+		}
+	}
+
+	uint64_t nb_to_write=0;
+	uint32_t r;
+	for(r=0; r<nb_runs; r++)
+		nb_to_write+=runs[r].nb;
+
+	printf(" %.1fs\n%llu sectors changed, %u runs with %llu sectors (%.1fMB) to write.\n\n", now()-start, (unsigned long long)nb_changed, nb_runs, (unsigned long long)nb_to_write, (double)nb_to_write*SECTOR_SIZE/1024/1024);
+
+	if(dry_run)
+	{
+		for(r=0; r<nb_runs; r++)
+			printf("  sectors %llu-%llu\n", (unsigned long long)runs[r].first, (unsigned long long)(runs[r].first+runs[r].nb-1));
+		printf("\n");
+	}
+	else if(nb_runs)
+	{
+		printf("Writing..."); fflush(stdout);
+		start=now();
+		for(r=0; r<nb_runs; r++)
+		{
+			size_t nb_bytes=(size_t)runs[r].nb*SECTOR_SIZE;
+			uint64_t offset=runs[r].first*SECTOR_SIZE;
+			read_at(fd_new, chunk_new, nb_bytes, offset, new_name);
+			write_at(fd_target, chunk_new, nb_bytes, offset, target_name);
+		}
+		if(fsync(fd_target))
+			err(1, "writing %s failed", target_name);
+		double duration=now()-start;
+		printf(" %.1fs, %.1fMB/s\n", duration, nb_to_write*SECTOR_SIZE/1024/1024/duration);
+
+		//read back from the card, not from the cache of the kernel
+		posix_fadvise(fd_target, 0, 0, POSIX_FADV_DONTNEED);
+
+		printf("Verifying..."); fflush(stdout);
+		uint32_t nb_bad=0;
+		for(r=0; r<nb_runs; r++)
+		{
+			size_t nb_bytes=(size_t)runs[r].nb*SECTOR_SIZE;
+			uint64_t offset=runs[r].first*SECTOR_SIZE;
+			read_at(fd_new, chunk_new, nb_bytes, offset, new_name);
+			if(read_at(fd_target, chunk_old, nb_bytes, offset, target_name)!=nb_bytes || memcmp(chunk_new, chunk_old, nb_bytes))
+			{
+				if(!nb_bad)
+					printf("\n");
+				printf("  sectors %llu-%llu differ!\n", (unsigned long long)runs[r].first, (unsigned long long)(runs[r].first+runs[r].nb-1));
+				nb_bad++;
+			}
+		}
+		if(nb_bad)
+			errx(1, "verification failed for %u runs", nb_bad);
+		printf(" ok\n\n");
+	}
+
+	if(save_manifest)
+	{
+		if(fclose(save_manifest) || rename(save_manifest_tmp, save_manifest_name))
+			err(1, "writing %s failed", save_manifest_name);
+		save_manifest_tmp[0]='\0';
+	}
+	if(manifest)
+		fclose(manifest);
+	if(fd_old>=0 && fd_old!=fd_target)
+		close(fd_old);
+	if(close(fd_target))
+		err(1, "writing %s failed", target_name);
+	close(fd_new);
+	free(chunk_new);
+	free(chunk_old);
+	free(runs);
+
+	printf("all done!\n\n");
+
+	return 0;
+}
@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include <avr/pgmspace.h>
 #include <avr/interrupt.h>
 
@@ -11,6 +12,8 @@
 
 #include "sd.h"
 
+#include "pdm_header.h"
+
 /*
 This file is part of mega328-pdm-audio (c) 2022 by kittennbfive.
 
@@ -21,12 +24,39 @@ Please read the fine manual!
 version 29.05.22
 */
 
-#define VALUE_UBBR 8 //ADJUST THIS! (see documentation)
+#define VALUE_UBBR 8 //ADJUST THIS if the data has no header! (see documentation)
+
+#define SECTOR_MAX 79557 //ADJUST THIS if the data has no header! (see documentation)
+
+#define PCM_MODE 0 //set to 1 if the card contains 8 bit PCM (pdmconv --pcm8), the AVR will do the modulation (see documentation)
+
+#define OSR 24 //only used with PCM_MODE, ADJUST THIS if the data has no header! must be a multiple of 4
 
-#define SECTOR_MAX 79557 //ADJUST THIS! (see documentation)
+#define COMPRESSED 0 //set to 1 if the data was made with pdmconv --compress (see documentation)
 
 
+#if PCM_MODE
+#define SZ_BUFFER 256 //do not change unless you want to hack!
+#define SZ_PCM_BUFFER 512 //one sector
+#else
 #define SZ_BUFFER 512 //do not change unless you want to hack!
+#endif
+
+#if PCM_MODE && (OSR%4)
+#error OSR must be a multiple of 4 with PCM_MODE
+#endif
+
+#if PCM_MODE && COMPRESSED
+#error PCM_MODE and COMPRESSED cannot be used together
+#endif
+
+#if PCM_MODE
+#define CODEC_OF_FIRMWARE PDM_HEADER_CODEC_PCM8
+#elif COMPRESSED
+#define CODEC_OF_FIRMWARE PDM_HEADER_CODEC_HUFFMAN
+#else
+#define CODEC_OF_FIRMWARE PDM_HEADER_CODEC_NONE
+#endif
 
 void sd_handle_io_error(const sd_error_t err)
 {
@@ -54,6 +84,285 @@ static volatile uint16_t * index_ptr_sd=&index_b2;
 
 static volatile bool fill_buffer=false;
 
+//from the header if there is one
+static uint32_t first_sector=0;
+static uint32_t sector_end=SECTOR_MAX;
+static uint32_t loop_start=0; //playback goes back to loop_start when it reaches loop_end
+static uint32_t loop_end=0; //0 if the data doesn't loop
+#if PCM_MODE
+static uint8_t bytes_per_sample=2*OSR/8;
+#endif
+
+//returns false if data does not contain a valid header, halts if the file can't be played by this firmware
+static bool parse_header(uint8_t const * const data, uint16_t * const ubbr)
+{
+	pdm_header_t const * const header=(pdm_header_t const *)data;
+
+	if(memcmp(header->magic, PDM_HEADER_MAGIC, 4) || header->version!=PDM_HEADER_VERSION || header->checksum!=pdm_header_checksum(header))
+		return false;
+
+	printf_P(PSTR("header: %uHz OSR %u codec %u, %lu sectors\r\n"), header->sample_rate, header->osr, header->codec, header->nb_sectors);
+
+	if(header->codec!=CODEC_OF_FIRMWARE)
+	{
+		printf_P(PSTR("this firmware can't play codec %u (see PCM_MODE and COMPRESSED)\r\n"), header->codec);
+		while(1);
+	}
+
+	if(header->nb_sectors==0)
+	{
+		printf_P(PSTR("no data\r\n"));
+		while(1);
+	}
+
+#if PCM_MODE
+	if(header->osr%4)
+	{
+		printf_P(PSTR("OSR must be a multiple of 4\r\n"));
+		while(1);
+	}
+	bytes_per_sample=2*header->osr/8;
+#endif
+
+	if(header->f_cpu==F_CPU)
+		(*ubbr)=header->ubbr;
+	else //file was made for another clock
+		(*ubbr)=(F_CPU/((uint32_t)header->sample_rate*header->osr)+2)/4-1;
+
+	first_sector=1;
+	sector_end=1+header->nb_sectors;
+
+	if(header->loop_end)
+	{
+		printf_P(PSTR("loop: sectors %lu to %lu\r\n"), header->loop_start, header->loop_end);
+		loop_start=1+header->loop_start;
+		loop_end=1+header->loop_end;
+	}
+
+	return true;
+}
+
+static uint32_t next_sector(const uint32_t sector)
+{
+	if(sector+1==loop_end)
+		return loop_start;
+	return sector+1;
+}
+
+#if PCM_MODE
+static uint8_t pcm_buffer[SZ_PCM_BUFFER];
+static uint16_t pcm_index=SZ_PCM_BUFFER;
+static int8_t pcm_sample;
+static uint8_t bytes_left_for_sample=0;
+
+static int16_t integrator1=0, integrator2=0;
+
+//normal audio keeps the integrators below about 1000 and 6000, but loud content close to half the sample rate overloads the modulator at low OSR and they would run away
+//clamped once per byte to these limits they can't overflow whatever the sample: in 8 bits integrator2 changes by at most 8*2048+28*255+8*128=24548
+#define PCM_INTEGRATOR1_LIMIT 2048
+#define PCM_INTEGRATOR2_LIMIT 8192
+
+//second-order modulator (AoE3 figure 13.55) for 8 bit input
+static uint8_t modulate_byte(const int8_t sample)
+{
+	uint8_t packed=0;
+	uint8_t bit;
+
+	if(integrator1>PCM_INTEGRATOR1_LIMIT)
+		integrator1=PCM_INTEGRATOR1_LIMIT;
+	else if(integrator1<-PCM_INTEGRATOR1_LIMIT)
+		integrator1=-PCM_INTEGRATOR1_LIMIT;
+	if(integrator2>PCM_INTEGRATOR2_LIMIT)
+		integrator2=PCM_INTEGRATOR2_LIMIT;
+	else if(integrator2<-PCM_INTEGRATOR2_LIMIT)
+		integrator2=-PCM_INTEGRATOR2_LIMIT;
+
+	for(bit=0; bit<8; bit++)
+	{
+		integrator2+=integrator1;
+		packed<<=1;
+		if(integrator2<0)
+		{
+			integrator1+=(int16_t)sample+128;
+			integrator2+=128;
+		}
+		else
+		{
+			packed|=1;
+			integrator1+=(int16_t)sample-127;
+			integrator2-=127;
+		}
+	}
+
+	return packed;
+}
+
+//returns false if there is no more data on the card
+static bool fill_buffer_pcm(volatile uint8_t * const buffer, uint32_t * const sector)
+{
+	uint16_t i;
+
+	for(i=0; i<SZ_BUFFER; i++)
+	{
+		if(bytes_left_for_sample==0)
+		{
+			if(pcm_index==SZ_PCM_BUFFER)
+			{
+				if((*sector)>=sector_end)
+					return false;
+				DEBUG|=(1<<DBG0);
+				sd_read_sector(*sector, pcm_buffer);
+				(*sector)=next_sector(*sector);
+				DEBUG&=~(1<<DBG0);
+				pcm_index=0;
+			}
+			pcm_sample=(int8_t)pcm_buffer[pcm_index++];
+			bytes_left_for_sample=bytes_per_sample;
+		}
+		bytes_left_for_sample--;
+		buffer[i]=modulate_byte(pcm_sample);
+	}
+
+	return true;
+}
+#endif
+
+
+#if !PCM_MODE && !COMPRESSED
+//returns false if there is no more data on the card
+static bool read_pdm_sector(volatile uint8_t * const buffer, uint32_t * const sector)
+{
+	if((*sector)>=sector_end)
+		return false;
+	sd_read_sector(*sector, (uint8_t*)buffer);
+	(*sector)=next_sector(*sector);
+	return true;
+}
+#endif
+
+#if COMPRESSED
+#define PDM_CODEC_DECODER 1
+#include "pdm_codec.h"
+
+static uint8_t sector_buffer[512];
+static uint16_t sector_buffer_index=512;
+static uint32_t sector_codec;
+
+static uint8_t codec_read_byte(void)
+{
+	if(sector_buffer_index==512)
+	{
+		if(sector_codec>=sector_end)
+			return 0; //reads as PDM_CODEC_END
+		DEBUG|=(1<<DBG0);
+		sd_read_sector(sector_codec, sector_buffer);
+		sector_codec=next_sector(sector_codec);
+		DEBUG&=~(1<<DBG0);
+		sector_buffer_index=0;
+	}
+	return sector_buffer[sector_buffer_index++];
+}
+
+static uint16_t codec_payload_left;
+
+static uint8_t codec_read_payload_byte(void)
+{
+	if(codec_payload_left==0)
+		return 0;
+	codec_payload_left--;
+	return codec_read_byte();
+}
+
+//returns false at the end of the data, needs at most PDM_CODEC_MAX_CODE_LENGTH-PDM_CODEC_LUT_BITS+1 table lookups per byte
+static bool codec_decode_block(volatile uint8_t * const buffer)
+{
+	uint16_t header=codec_read_byte();
+	header|=(uint16_t)codec_read_byte()<<8;
+
+	if(header==PDM_CODEC_END && loop_end)
+	{
+		//end of the part before the loop or of the loop, the next block starts at the next sector (which is the loop start after the loop)
+		sector_buffer_index=512;
+		header=codec_read_byte();
+		header|=(uint16_t)codec_read_byte()<<8;
+	}
+
+	if(header==PDM_CODEC_END)
+		return false;
+
+	uint16_t i;
+
+	if(header==PDM_CODEC_STORED)
+	{
+		for(i=0; i<PDM_CODEC_BLOCK_SIZE; i++)
+			buffer[i]=codec_read_byte();
+		return true;
+	}
+
+	codec_payload_left=header;
+
+	uint16_t window=0; //next bits of the payload, MSB first
+	uint8_t nb_bits=0;
+	uint8_t previous=0;
+
+	for(i=0; i<PDM_CODEC_BLOCK_SIZE; i++)
+	{
+		while(nb_bits<=8)
+		{
+			window|=(uint16_t)codec_read_payload_byte()<<(8-nb_bits);
+			nb_bits+=8;
+		}
+
+		uint8_t table=pgm_read_byte(&pdm_codec_table_of_context[previous]);
+		uint8_t peek=window>>8;
+		uint8_t len=pgm_read_byte(&pdm_codec_lut_len[table][peek]);
+		uint8_t symbol=0;
+
+		if(len)
+		{
+			symbol=pgm_read_byte(&pdm_codec_lut_sym[table][peek]);
+			window<<=len;
+			nb_bits-=len;
+		}
+		else
+		{
+			//long code, continue bit by bit
+			uint16_t code=peek;
+			window<<=PDM_CODEC_LUT_BITS;
+			nb_bits-=PDM_CODEC_LUT_BITS;
+
+			uint8_t l;
+			for(l=0; l<PDM_CODEC_MAX_CODE_LENGTH-PDM_CODEC_LUT_BITS; l++)
+			{
+				if(nb_bits==0)
+				{
+					window=(uint16_t)codec_read_payload_byte()<<8;
+					nb_bits=8;
+				}
+				code=(code<<1)|(window>>15);
+				window<<=1;
+				nb_bits--;
+
+				uint16_t offset=code-pgm_read_word(&pdm_codec_long_first[table][l]);
+				if(offset<pgm_read_byte(&pdm_codec_long_count[table][l]))
+				{
+					symbol=pgm_read_byte(&pdm_codec_long_symbols[pgm_read_word(&pdm_codec_long_index[table][l])+offset]);
+					break;
+				}
+			}
+		}
+
+		buffer[i]=symbol;
+		previous=symbol;
+	}
+
+	//only for corrupted data
+	while(codec_payload_left)
+		codec_read_payload_byte();
+
+	return true;
+}
+#endif
 
 ISR(USART_UDRE_vect)
 {
@@ -81,7 +390,6 @@ int main(void)
 	UBRR0=0;
 	UCSR0B=(1<<TXEN0)|(1<<UDRIE0);
 	UCSR0C=(1<<UMSEL01)|(1<<UMSEL00);
-	UBRR0=VALUE_UBBR;
 
 	//software UART
 	sw_uart_tx_init();
@@ -103,30 +411,77 @@ int main(void)
 
 	printf_P(PSTR("sd_init ok\r\n"));
 
+	uint16_t ubbr=VALUE_UBBR;
 	sd_read_sector(0, (uint8_t*)buffer1);
-	sd_read_sector(1, (uint8_t*)buffer2);
+	if(!parse_header((uint8_t*)buffer1, &ubbr))
+		printf_P(PSTR("no header, using settings from the code\r\n"));
+	UBRR0=ubbr;
+
+#if PCM_MODE
+	uint32_t sector=first_sector;
+
+	fill_buffer_pcm(buffer1, &sector);
+	fill_buffer_pcm(buffer2, &sector);
+#elif COMPRESSED
+	sector_codec=first_sector;
+	codec_decode_block(buffer1);
+	codec_decode_block(buffer2);
+#else
+	uint32_t sector=first_sector;
+
+	read_pdm_sector(buffer1, &sector);
+	read_pdm_sector(buffer2, &sector);
+#endif
 
 	printf_P(PSTR("initial buffer filled, starting playback\r\n"));
 
-	uint32_t sector=2;
-
 	sei();
 
 	while(1)
 	{
+#if PCM_MODE
+		if(fill_buffer)
+		{
+			fill_buffer=false;
+			(*index_ptr_sd)=0;
+			DEBUG|=(1<<DBG1);
+			bool more_data=fill_buffer_pcm(buffer_ptr_sd, &sector);
+			DEBUG&=~(1<<DBG1);
+			if(!more_data)
+			{
+				cli();
+				break;
+			}
+		}
+#elif COMPRESSED
+		if(fill_buffer)
+		{
+			fill_buffer=false;
+			(*index_ptr_sd)=0;
+			DEBUG|=(1<<DBG1);
+			bool more_data=codec_decode_block(buffer_ptr_sd);
+			DEBUG&=~(1<<DBG1);
+			if(!more_data)
+			{
+				cli();
+				break;
+			}
+		}
+#else
 		if(fill_buffer)
 		{
 			fill_buffer=false;
 			(*index_ptr_sd)=0;
 			DEBUG|=(1<<DBG0);
-			sd_read_sector(sector, (uint8_t*)buffer_ptr_sd);
+			bool more_data=read_pdm_sector(buffer_ptr_sd, &sector);
 			DEBUG&=~(1<<DBG0);
-			if(++sector==SECTOR_MAX)
+			if(!more_data)
 			{
 				cli();
 				break;
 			}
 		}
+#endif
 	}
 
 	printf_P(PSTR("finished, going into endless loop\r\n"));
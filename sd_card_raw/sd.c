@@ -135,20 +135,9 @@ sd_init_result_t sd_init(void)
 	return SD_NO_ERROR;
 }
 
-void sd_read_sector(const uint32_t block, uint8_t * const ptr)
+static void sd_receive_data_block(uint8_t * const ptr)
 {
-	//send dummy clock - IMPORTANT!
-	spi_send_receive(0xFF);
-	
 	uint8_t resp;
-	SD_CS_LOW;
-	resp=sd_send_command(17, (block>>24)&0xFF, (block>>16)&0xFF, (block>>8)&0xFF, block&0xFF, 0x00);
-	if(resp!=0x00)
-	{
-		SD_CS_HIGH;
-		sd_handle_io_error(SD_READ_ERROR_CMD17);
-	}
-	
 	do
 	{
 		resp=spi_send_receive(0xFF);
@@ -167,31 +156,61 @@ void sd_read_sector(const uint32_t block, uint8_t * const ptr)
 	//crc must be received but will be ignored
 	(void)spi_send_receive(0xFF);
 	(void)spi_send_receive(0xFF);
-	
-	SD_CS_HIGH;
 }
 
-void sd_write_sector(const uint32_t block, uint8_t const * const ptr)
+void sd_read_sector(const uint32_t block, uint8_t * const ptr)
 {
 	//send dummy clock - IMPORTANT!
 	spi_send_receive(0xFF);
 	
 	uint8_t resp;
 	SD_CS_LOW;
-	resp=sd_send_command(24, (block>>24)&0xFF, (block>>16)&0xFF, (block>>8)&0xFF, block&0xFF, 0x00);
+	resp=sd_send_command(17, (block>>24)&0xFF, (block>>16)&0xFF, (block>>8)&0xFF, block&0xFF, 0x00);
 	if(resp!=0x00)
 	{
 		SD_CS_HIGH;
-		sd_handle_io_error(SD_WRITE_ERROR_CMD24);
+		sd_handle_io_error(SD_READ_ERROR_CMD17);
 	}
 	
-	spi_send_receive(0xFE); //start block token
-	uint16_t i;
-	for(i=0; i<512; i++)
+	sd_receive_data_block(ptr);
+	
+	SD_CS_HIGH;
+}
+
+void sd_read_multiple_start(const uint32_t block)
+{
+	//send dummy clock - IMPORTANT!
+	spi_send_receive(0xFF);
+	
+	uint8_t resp;
+	SD_CS_LOW;
+	resp=sd_send_command(18, (block>>24)&0xFF, (block>>16)&0xFF, (block>>8)&0xFF, block&0xFF, 0x00);
+	if(resp!=0x00)
 	{
-		spi_send_receive(ptr[i]);
+		SD_CS_HIGH;
+		sd_handle_io_error(SD_READ_ERROR_CMD18);
 	}
 	
+	//CS stays low until sd_read_multiple_stop(), the card waits as long as there is no clock
+}
+
+void sd_read_multiple_sector(uint8_t * const ptr)
+{
+	sd_receive_data_block(ptr);
+}
+
+static void sd_wait_while_busy(void)
+{
+	uint8_t resp;
+	do
+	{
+		resp=spi_send_receive(0xFF);
+	} while(resp==0x00); //wait while card is busy
+}
+
+static void sd_check_data_response(void)
+{
+	uint8_t resp;
 	do
 	{
 		resp=spi_send_receive(0xFF);
@@ -214,11 +233,126 @@ void sd_write_sector(const uint32_t block, uint8_t const * const ptr)
 		SD_CS_HIGH;
 		sd_handle_io_error(error);
 	}
+}
+
+void sd_write_sector(const uint32_t block, uint8_t const * const ptr)
+{
+	//send dummy clock - IMPORTANT!
+	spi_send_receive(0xFF);
+	
+	uint8_t resp;
+	SD_CS_LOW;
+	resp=sd_send_command(24, (block>>24)&0xFF, (block>>16)&0xFF, (block>>8)&0xFF, block&0xFF, 0x00);
+	if(resp!=0x00)
+	{
+		SD_CS_HIGH;
+		sd_handle_io_error(SD_WRITE_ERROR_CMD24);
+	}
 	
+	spi_send_receive(0xFE); //start block token
+	uint16_t i;
+	for(i=0; i<512; i++)
+	{
+		spi_send_receive(ptr[i]);
+	}
+	
+	sd_check_data_response();
+	
+	sd_wait_while_busy();
+	
+	SD_CS_HIGH;
+}
+
+void sd_write_multiple_start(const uint32_t block, const uint32_t nb_blocks_pre_erase)
+{
+	//send dummy clock - IMPORTANT!
+	spi_send_receive(0xFF);
+	
+	uint8_t resp;
+	
+	//ACMD23 = CMD55+"CMD23": tell the card how many blocks will follow so it can erase them beforehand. This is only a hint, sending more or less blocks is allowed.
+	if(nb_blocks_pre_erase)
+	{
+		SD_CS_LOW;
+		resp=sd_send_command(55, 0, 0, 0, 0, 0);
+		if(resp!=0x00)
+		{
+			SD_CS_HIGH;
+			sd_handle_io_error(SD_WRITE_ERROR_ACMD23);
+		}
+		resp=sd_send_command(23, (nb_blocks_pre_erase>>24)&0x7F, (nb_blocks_pre_erase>>16)&0xFF, (nb_blocks_pre_erase>>8)&0xFF, nb_blocks_pre_erase&0xFF, 0x00);
+		SD_CS_HIGH;
+		if(resp!=0x00)
+			sd_handle_io_error(SD_WRITE_ERROR_ACMD23);
+		
+		spi_send_receive(0xFF);
+	}
+	
+	SD_CS_LOW;
+	resp=sd_send_command(25, (block>>24)&0xFF, (block>>16)&0xFF, (block>>8)&0xFF, block&0xFF, 0x00);
+	if(resp!=0x00)
+	{
+		SD_CS_HIGH;
+		sd_handle_io_error(SD_WRITE_ERROR_CMD25);
+	}
+	
+	//CS stays low until sd_write_multiple_stop()
+}
+
+void sd_write_multiple_sector(uint8_t const * const ptr)
+{
+	spi_send_receive(0xFF);
+	
+	spi_send_receive(0xFC); //start block token for multi-block write
+	uint16_t i;
+	for(i=0; i<512; i++)
+	{
+		spi_send_receive(ptr[i]);
+	}
+	
+	//crc must be sent but will be ignored
+	spi_send_receive(0xFF);
+	spi_send_receive(0xFF);
+	
+	sd_check_data_response();
+	
+	sd_wait_while_busy();
+}
+
+void sd_read_multiple_stop(void)
+{
+	//CMD12 can't use sd_send_command(): the byte following the command is a stuff byte that may look like a response
+	spi_send_receive((0<<7)|(1<<6)|12);
+	spi_send_receive(0);
+	spi_send_receive(0);
+	spi_send_receive(0);
+	spi_send_receive(0);
+	spi_send_receive(0x01);
+	(void)spi_send_receive(0xFF); //stuff byte
+	
+	uint8_t resp;
 	do
 	{
 		resp=spi_send_receive(0xFF);
-	} while(resp==0x00); //wait while card is busy
+	} while(resp&(1<<7));
+	
+	sd_wait_while_busy();
+	
+	SD_CS_HIGH;
+	
+	if(resp!=0x00)
+		sd_handle_io_error(SD_READ_ERROR_CMD12);
+}
+
+void sd_write_multiple_stop(void)
+{
+	spi_send_receive(0xFF);
+	
+	spi_send_receive(0xFD); //stop transmission token
+	
+	spi_send_receive(0xFF); //skip one byte before busy is signaled
+	
+	sd_wait_while_busy();
 	
 	SD_CS_HIGH;
 }
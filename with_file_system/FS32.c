@@ -32,26 +32,125 @@ static uint32_t FATSz32; //number of sectors for one FAT
 static uint32_t RootSector; //sector where the root dir is
 static uint32_t FirstDataSector;
 static uint32_t TotalNbOfDataSectors;
-static uint8_t FATIndexLastEntry;
 static fat32_entry_t EndOfClusterChainMarker;
 static uint32_t NbFreeSectors;
 static uint32_t LastAllocatedSector;
+#if FS32_BOOT_CACHE_SUPPORT
+static uint32_t VolumeID; //BS_VolID, identifies the card for the caches of f_init_cached() and f_open_cached()
+#endif
 static file_t OpenFiles[FS32_NB_FILES_MAX];
 
 static uint8_t Buffer[512];
+static uint32_t BufferLogicalSector; //data sector f_read() left in Buffer, 0 == unknown. Everything else touching Buffer or writing to the card resets this.
+
+#if FS32_IO_STATS
+static FS32_stats_t IOStats;
+#endif
+
+#if FS32_MULTI_BLOCK_READ_SUPPORT
+static uint32_t ReadStreamNextSector; //logical sector the open multi-block read delivers next, 0 == no multi-block read open
+static uint32_t ReadStreamNbLeft; //sectors left in the contiguous run that is known to follow
+
+static void fs32_stop_read_stream(void)
+{
+	if(ReadStreamNextSector)
+	{
+		sd_read_multiple_stop();
+		ReadStreamNbLeft=0;
+		ReadStreamNextSector=0;
+	}
+}
+#endif
+
+#if FS32_FREE_RUN_CACHE_SIZE
+static free_run_t FreeRuns[FS32_FREE_RUN_CACHE_SIZE]; //known extents of free sectors, every sector in here is free on the card
+static uint8_t NbFreeRuns;
+static uint32_t FreeRunScanPos; //where the next refill starts scanning the FAT
+#endif
 
 #define IS_EOC_MARKER(value) (value>=0x0FFFFFF8 && value<=0x0FFFFFFF)
 
 #define LOGICAL_SECTOR_TO_PHYSICAL(datasector) ((datasector-2)+FirstDataSector)
 
+#if FS32_FAT_CACHE
+static uint8_t FATCache[512];
+static uint32_t FATCacheSector; //0 == cache empty, sector 0 is never part of the FAT
+static bool FATCacheDirty;
+static bool FSInfoDirty;
+#endif
+
 #if !FS32_NO_APPEND || !FS32_NO_WRITE
-static void update_fsinfo(void)
+static void write_fsinfo(void)
 {
-	SD_READ_SECTOR(1, Buffer);
+	BufferLogicalSector=0;
+	SD_READ_SECTOR(FS32_IO_FSINFO, 1, Buffer);
 	fat32_fsinfo_t *fsinfo=(fat32_fsinfo_t*)Buffer;
 	fsinfo->FSI_Free_Count=NbFreeSectors;
 	fsinfo->FSI_Last_Allocated=LastAllocatedSector;
-	SD_WRITE_SECTOR(1, Buffer);
+	SD_WRITE_SECTOR(FS32_IO_FSINFO, 1, Buffer);
+}
+
+static void update_fsinfo(void)
+{
+#if FS32_FAT_CACHE
+	FSInfoDirty=true;
+#else
+	write_fsinfo();
+#endif
+}
+#endif
+
+#if FS32_FAT_CACHE
+static void fat32_flush_fat_cache(void)
+{
+	if(FATCacheDirty)
+	{
+		SD_WRITE_SECTOR(FS32_IO_FAT, FATCacheSector, FATCache);
+		FATCacheDirty=false;
+	}
+}
+#endif
+
+#if FS32_FAT_CACHE && (!FS32_NO_APPEND || !FS32_NO_WRITE)
+static void fs32_sync(void)
+{
+	fat32_flush_fat_cache();
+	
+	if(FSInfoDirty)
+	{
+		write_fsinfo();
+		FSInfoDirty=false;
+	}
+}
+#endif
+
+static fat32_entry_t * fat32_load_fat_sector(const uint32_t sector)
+{
+#if FS32_FAT_CACHE
+	if(sector!=FATCacheSector)
+	{
+		fat32_flush_fat_cache();
+		SD_READ_SECTOR(FS32_IO_FAT, sector, FATCache);
+		FATCacheSector=sector;
+	}
+	return (fat32_entry_t*)FATCache;
+#else
+	BufferLogicalSector=0;
+	SD_READ_SECTOR(FS32_IO_FAT, sector, Buffer);
+	return (fat32_entry_t*)Buffer;
+#endif
+}
+
+#if !FS32_NO_APPEND || !FS32_NO_WRITE
+static void fat32_store_fat_sector(const uint32_t sector)
+{
+	//call this after modifying the entries returned by fat32_load_fat_sector()
+#if FS32_FAT_CACHE
+	(void)sector;
+	FATCacheDirty=true;
+#else
+	SD_WRITE_SECTOR(FS32_IO_FAT, sector, Buffer);
+#endif
 }
 #endif
 
@@ -66,16 +165,14 @@ static pos_fat32_entry_t get_pos_fat_entry(const uint32_t sector)
 
 static fat32_entry_t fat32_read_entry(pos_fat32_entry_t const * const pos)
 {
-	SD_READ_SECTOR(pos->FAT_SectorNumber, Buffer);
-	return ((fat32_entry_t*)Buffer)[pos->FAT_EntryIndex]&0x0FFFFFFF;
+	return fat32_load_fat_sector(pos->FAT_SectorNumber)[pos->FAT_EntryIndex]&0x0FFFFFFF;
 }
 
 #if !FS32_NO_APPEND || !FS32_NO_WRITE
 static void fat32_write_entry(pos_fat32_entry_t const * const pos, const uint32_t nextSector)
 {
-	SD_READ_SECTOR(pos->FAT_SectorNumber, Buffer);
-	((fat32_entry_t*)Buffer)[pos->FAT_EntryIndex]=nextSector;
-	SD_WRITE_SECTOR(pos->FAT_SectorNumber, Buffer);
+	fat32_load_fat_sector(pos->FAT_SectorNumber)[pos->FAT_EntryIndex]=nextSector;
+	fat32_store_fat_sector(pos->FAT_SectorNumber);
 }
 #endif
 
@@ -90,17 +187,41 @@ static uint32_t fat32_get_next_sector(const uint32_t sector)
 	return entry;
 }
 
-static void read_logical_sector(const uint32_t sector, uint8_t * const data)
+#if FS32_MULTI_BLOCK_READ_SUPPORT || FS32_BOOT_CACHE_SUPPORT
+static uint32_t fat32_count_contiguous(const uint32_t sector, const uint32_t max)
+{
+	//number of sectors (at most max) starting at sector that follow each other on the card, each FAT sector is loaded once
+	uint32_t n=1;
+	while(n<max)
+	{
+		pos_fat32_entry_t pos=get_pos_fat_entry(sector+n-1);
+		fat32_entry_t const * entries=fat32_load_fat_sector(pos.FAT_SectorNumber);
+		uint8_t i;
+		for(i=pos.FAT_EntryIndex; i<128 && n<max; i++)
+		{
+			if((entries[i]&0x0FFFFFFF)!=sector+n)
+				return n;
+			n++;
+		}
+	}
+	
+	return n;
+}
+#endif
+
+static void read_logical_sector(const uint32_t sector, uint8_t * const data, const uint8_t io_class)
 {
 	uint32_t Physical=LOGICAL_SECTOR_TO_PHYSICAL(sector);
-	SD_READ_SECTOR(Physical, data);
+	BufferLogicalSector=0;
+	SD_READ_SECTOR(io_class, Physical, data);
 }
 
 #if !FS32_NO_APPEND || !FS32_NO_WRITE
-static void write_logical_sector(const uint32_t sector, uint8_t const * const data)
+static void write_logical_sector(const uint32_t sector, uint8_t const * const data, const uint8_t io_class)
 {
 	uint32_t Physical=LOGICAL_SECTOR_TO_PHYSICAL(sector);
-	SD_WRITE_SECTOR(Physical, data);
+	BufferLogicalSector=0;
+	SD_WRITE_SECTOR(io_class, Physical, data);
 }
 #endif
 
@@ -137,12 +258,72 @@ void filename_to_fat32(uint8_t filenr, fat32_directory_entry_t * const entry)
 	}
 }
 
+#if !FS32_NO_LONG_NAMES
+static uint8_t fat32_short_name_checksum(fat32_directory_entry_t const * const entry)
+{
+	uint8_t sum=0;
+	uint8_t i;
+	for(i=0; i<8; i++)
+		sum=((sum&1)<<7)+(sum>>1)+(uint8_t)entry->DIR_Name[i];
+	for(i=0; i<3; i++)
+		sum=((sum&1)<<7)+(sum>>1)+(uint8_t)entry->DIR_Ext[i];
+	return sum;
+}
+
+static uint16_t fat32_lfn_get_char(fat32_lfn_entry_t const * const entry, const uint8_t i)
+{
+	if(i<5)
+		return entry->LDIR_Name1[i];
+	else if(i<11)
+		return entry->LDIR_Name2[i-5];
+	else
+		return entry->LDIR_Name3[i-11];
+}
+
+static bool fat32_lfn_part_matches(fat32_lfn_entry_t const * const entry, char const * const filename, const uint8_t len)
+{
+	//compare the up to 13 characters stored in this entry against the corresponding part of filename, case-insensitive, ASCII only
+	uint8_t pos=((entry->LDIR_Ord&LFN_ORD_MASK)-1)*13;
+	uint8_t i;
+	for(i=0; i<13; i++, pos++)
+	{
+		uint16_t c=fat32_lfn_get_char(entry, i);
+		
+		if(pos>len)
+			break; //padding
+		
+		if(pos==len)
+			return c==0x0000;
+		
+		char f=filename[pos];
+		if(f>='a' && f<='z')
+			f-='a'-'A';
+		if(c>='a' && c<='z')
+			c-='a'-'A';
+		
+		if(c!=(uint8_t)f)
+			return false;
+	}
+	
+	return true;
+}
+#endif
+
 static void fat32_search_for_file(FIRST_ARG_FILENR char const * const filename)
 {
 	OpenFiles[FILENR_ARR_INDEX].FileFound=false;
 	
 	uint32_t cl=RootSector;
 	
+#if !FS32_NO_LONG_NAMES
+	//long names are compared while walking through the directory, no need to assemble them in RAM
+	//the entries of a long name are stored in reverse order (highest ordinal first) right before the short entry and may span sectors
+	const uint8_t len=strlen(filename);
+	uint8_t LfnNextOrd=0; //ordinal expected for the next long name entry, 0 if none
+	uint8_t LfnChecksum=0;
+	bool LfnMatches=false; //all entries so far matched and the sequence is complete if LfnNextOrd==0
+#endif
+	
 	while(!IS_EOC_MARKER(cl))
 	{
 		fat32_directory_entry_t DirEntry;
@@ -150,14 +331,19 @@ static void fat32_search_for_file(FIRST_ARG_FILENR char const * const filename)
 		
 		bool NoMoreEntries=false;
 		
-		read_logical_sector(cl, Buffer);
+		read_logical_sector(cl, Buffer, FS32_IO_DIR);
 		
 		for(NbEntry=0; NbEntry<512/sizeof(fat32_directory_entry_t); NbEntry++)
 		{
 			memcpy(&DirEntry, &(((fat32_directory_entry_t*)Buffer)[NbEntry]), sizeof(fat32_directory_entry_t));
 			
 			if((uint8_t)DirEntry.DIR_Name[0]==DIR_ENTRY_FREE)
+			{
+#if !FS32_NO_LONG_NAMES
+				LfnMatches=false;
+#endif
 				continue;
+			}
 			
 			if((uint8_t)DirEntry.DIR_Name[0]==DIR_ENTRY_FREE_NO_MORE_DIR)
 			{
@@ -165,21 +351,46 @@ static void fat32_search_for_file(FIRST_ARG_FILENR char const * const filename)
 				break;
 			}
 			
-			if(DirEntry.DIR_Attr&ATTR_LONG_NAME)
+			if(IS_LONG_NAME_ENTRY(DirEntry.DIR_Attr))
 			{
-				//LONG NAMES ARE UNSUPPORTED!
-				break;
+#if !FS32_NO_LONG_NAMES
+				fat32_lfn_entry_t const * const Lfn=(fat32_lfn_entry_t*)&DirEntry;
+				uint8_t Ord=Lfn->LDIR_Ord&LFN_ORD_MASK;
+				
+				if(Lfn->LDIR_Ord&LFN_LAST_LONG_ENTRY) //first entry of a new long name
+				{
+					LfnMatches=(Ord==(len+12)/13);
+					LfnChecksum=Lfn->LDIR_Chksum;
+				}
+				else if(Ord!=LfnNextOrd || Lfn->LDIR_Chksum!=LfnChecksum)
+					LfnMatches=false;
+				
+				if(LfnMatches)
+					LfnMatches=fat32_lfn_part_matches(Lfn, filename, len);
+				
+				LfnNextOrd=Ord-1;
+#endif
+				continue;
 			}
 			
 			char Name[8+1+3+1];
 			fat32_filename_to_string(&DirEntry, Name);
 			
-			if(!strcmp(Name, filename))
+			bool Match=!strcmp(Name, filename);
+			
+#if !FS32_NO_LONG_NAMES
+			if(LfnMatches && LfnNextOrd==0 && LfnChecksum==fat32_short_name_checksum(&DirEntry))
+				Match=true;
+			LfnMatches=false;
+#endif
+			
+			if(Match)
 			{
 				OpenFiles[FILENR_ARR_INDEX].FileFound=true;
 				OpenFiles[FILENR_ARR_INDEX].LogicalSector=((uint32_t)DirEntry.DIR_FstClusHI<<16)|DirEntry.DIR_FstClusLO;
 				OpenFiles[FILENR_ARR_INDEX].FirstLogicalSector=OpenFiles[FILENR_ARR_INDEX].LogicalSector; //needed for f_seek for file in modify-mode
 				OpenFiles[FILENR_ARR_INDEX].FileSize=DirEntry.DIR_FileSize;
+				OpenFiles[FILENR_ARR_INDEX].NbContiguousSectors=0; //unknown
 				OpenFiles[FILENR_ARR_INDEX].SectorDirEntry=cl;
 				OpenFiles[FILENR_ARR_INDEX].IndexDirEntry=NbEntry;
 				break;
@@ -194,52 +405,300 @@ static void fat32_search_for_file(FIRST_ARG_FILENR char const * const filename)
 }
 
 #if !FS32_NO_APPEND || !FS32_NO_WRITE
+static bool fat32_is_free(fat32_entry_t const * const entries, const uint8_t index)
+{
+	return (entries[index]&0x0FFFFFFF)==0x00000000;
+}
+
+#if FS32_FREE_RUN_CACHE_SIZE
+static void fat32_take_from_free_run(const uint8_t run, const uint32_t nb)
+{
+	FreeRuns[run].FirstSector+=nb;
+	FreeRuns[run].NbSectors-=nb;
+	
+	if(FreeRuns[run].NbSectors==0)
+	{
+		uint8_t i;
+		for(i=run; i<NbFreeRuns-1; i++)
+			FreeRuns[i]=FreeRuns[i+1];
+		NbFreeRuns--;
+	}
+}
+
+static void fat32_refill_free_runs(void)
+{
+	//scan the FAT starting where the last scan stopped until the cache is full or the end of the FAT is reached
+	//runs never wrap around the end of the FAT
+	uint32_t Sector=FreeRunScanPos;
+	uint32_t LoadedFATSector=0;
+	fat32_entry_t *entries=NULL;
+	bool InRun=false;
+	uint32_t NbChecked;
+	
+	NbFreeRuns=0;
+	
+	for(NbChecked=0; NbChecked<TotalNbOfDataSectors; NbChecked++, Sector++)
+	{
+		if(Sector<2 || Sector>=TotalNbOfDataSectors+2)
+		{
+			if(NbFreeRuns)
+				break; //wrap around only if nothing was found, the rest is scanned by the next refill
+			Sector=2;
+			InRun=false;
+		}
+		
+		pos_fat32_entry_t p=get_pos_fat_entry(Sector);
+		
+		if(p.FAT_SectorNumber!=LoadedFATSector)
+		{
+			entries=fat32_load_fat_sector(p.FAT_SectorNumber);
+			LoadedFATSector=p.FAT_SectorNumber;
+		}
+		
+		if(!fat32_is_free(entries, p.FAT_EntryIndex))
+			InRun=false;
+		else if(InRun)
+			FreeRuns[NbFreeRuns-1].NbSectors++;
+		else
+		{
+			if(NbFreeRuns==FS32_FREE_RUN_CACHE_SIZE)
+				break;
+			FreeRuns[NbFreeRuns].FirstSector=Sector;
+			FreeRuns[NbFreeRuns].NbSectors=1;
+			NbFreeRuns++;
+			InRun=true;
+		}
+	}
+	
+	FreeRunScanPos=Sector;
+}
+#endif
+
 static pos_fat32_entry_t fat32_get_next_free_entry(void)
 {
 	pos_fat32_entry_t p;
+	p.noFreeSpace=true;
 
 	if(NbFreeSectors==0)
-	{
-		p.noFreeSpace=true;
 		return p;
+	
+	uint32_t Sector;
+	
+#if FS32_FREE_RUN_CACHE_SIZE
+	if(NbFreeRuns==0)
+		fat32_refill_free_runs();
+	
+	if(NbFreeRuns==0)
+		return p;
+	
+	Sector=FreeRuns[0].FirstSector;
+	fat32_take_from_free_run(0, 1);
+#else
+	//search for a free entry starting after the last allocated sector, wrap around at the end of the FAT
+	Sector=LastAllocatedSector+1;
+	uint32_t LoadedFATSector=0;
+	fat32_entry_t *entries=NULL;
+	bool Found=false;
+	uint32_t NbChecked;
+	
+	for(NbChecked=0; NbChecked<TotalNbOfDataSectors; NbChecked++, Sector++)
+	{
+		if(Sector<2 || Sector>=TotalNbOfDataSectors+2)
+			Sector=2;
+		
+		pos_fat32_entry_t c=get_pos_fat_entry(Sector);
+		
+		if(c.FAT_SectorNumber!=LoadedFATSector)
+		{
+			entries=fat32_load_fat_sector(c.FAT_SectorNumber);
+			LoadedFATSector=c.FAT_SectorNumber;
+		}
+		
+		if(fat32_is_free(entries, c.FAT_EntryIndex))
+		{
+			Found=true;
+			break;
+		}
 	}
 	
-	NbFreeSectors--;
+	if(!Found)
+		return p;
+#endif
 	
-	p=get_pos_fat_entry(LastAllocatedSector+1);
+	p=get_pos_fat_entry(Sector);
 	p.noFreeSpace=false;
-	p.LogicalSector=LastAllocatedSector+1;
+	p.LogicalSector=Sector;
+	
+	NbFreeSectors--;
+	LastAllocatedSector=Sector;
 	
-	uint32_t Sector=p.FAT_SectorNumber;
-	uint8_t EntryIndex=p.FAT_EntryIndex;
+	update_fsinfo();
 
-	bool Found=false;
+	return p;
+}
+#endif
+
+#if FS32_MULTI_BLOCK_WRITE_SUPPORT || FS32_PREALLOC_SUPPORT
+static void fat32_link_run(const uint32_t previous, const uint32_t first, const uint32_t nb)
+{
+	//chain the free sectors first...first+nb-1, terminate them with EOC and append them to the chain ending at previous (if not 0)
+	//every FAT sector is loaded and stored only once for up to 128 entries
+	const uint32_t last=first+nb-1;
+	pos_fat32_entry_t p_prev=get_pos_fat_entry(previous);
+	bool PreviousLinked=(previous==0);
+	uint32_t sector=first;
+	
+	while(sector<=last)
+	{
+		pos_fat32_entry_t p=get_pos_fat_entry(sector);
+		fat32_entry_t *entries=fat32_load_fat_sector(p.FAT_SectorNumber);
+		
+		if(!PreviousLinked && p_prev.FAT_SectorNumber==p.FAT_SectorNumber)
+		{
+			entries[p_prev.FAT_EntryIndex]=first;
+			PreviousLinked=true;
+		}
+		
+		uint8_t EntryIndex;
+		for(EntryIndex=p.FAT_EntryIndex; EntryIndex<128 && sector<=last; EntryIndex++, sector++)
+			entries[EntryIndex]=(sector==last)?EndOfClusterChainMarker:sector+1;
+		
+		fat32_store_fat_sector(p.FAT_SectorNumber);
+	}
 	
-	for(; Sector<RsvdSecCnt+FATSz32; Sector++)
+	if(!PreviousLinked)
+		fat32_write_entry(&p_prev, first);
+	
+	NbFreeSectors-=nb;
+	if(last>LastAllocatedSector)
+		LastAllocatedSector=last;
+	
+	update_fsinfo();
+}
+#endif
+
+#if FS32_MULTI_BLOCK_WRITE_SUPPORT
+static uint32_t fat32_extend_contiguous(const uint32_t sector, const uint32_t nb)
+{
+	//allocate up to nb free sectors directly following sector (must be the end of a chain) and link them to it
+	uint32_t NbFree=0;
+	
+#if FS32_FREE_RUN_CACHE_SIZE
+	uint8_t run;
+	for(run=0; run<NbFreeRuns; run++)
 	{
-		SD_READ_SECTOR(Sector, Buffer);
+		if(FreeRuns[run].FirstSector==sector+1)
+		{
+			NbFree=FreeRuns[run].NbSectors;
+			if(NbFree>nb)
+				NbFree=nb;
+			fat32_take_from_free_run(run, NbFree);
+			break;
+		}
+	}
+#else
+	uint32_t LoadedFATSector=0;
+	fat32_entry_t *entries=NULL;
+	uint32_t Candidate;
+	
+	for(Candidate=sector+1; NbFree<nb && NbFree<NbFreeSectors && Candidate<TotalNbOfDataSectors+2; Candidate++, NbFree++)
+	{
+		pos_fat32_entry_t p=get_pos_fat_entry(Candidate);
 		
-		for(; EntryIndex<128; EntryIndex++)
+		if(p.FAT_SectorNumber!=LoadedFATSector)
 		{
-			if(Sector==RsvdSecCnt+FATSz32 && EntryIndex>FATIndexLastEntry)
-				break;
-			
-			if((((fat32_entry_t*)Buffer)[EntryIndex]&0x0FFFFFFF)==0x00000000)
-			{
-				Found=true;
-				LastAllocatedSector=(Sector-RsvdSecCnt)*128+EntryIndex;
-				break;
-			}
+			entries=fat32_load_fat_sector(p.FAT_SectorNumber);
+			LoadedFATSector=p.FAT_SectorNumber;
 		}
-		if(Found)
+		
+		if(!fat32_is_free(entries, p.FAT_EntryIndex))
 			break;
+	}
+#endif
+	
+	if(NbFree)
+		fat32_link_run(sector, sector+1, NbFree);
+	
+	return NbFree;
+}
+#endif
+
+#if FS32_PREALLOC_SUPPORT
+static uint32_t fat32_find_contiguous_free(const uint32_t nb)
+{
+	//returns the first sector of nb contiguous free sectors (removed from the free run cache) or 0 if there is no such run
+	
+#if FS32_FREE_RUN_CACHE_SIZE
+	uint8_t run;
+	for(run=0; run<NbFreeRuns; run++)
+	{
+		if(FreeRuns[run].NbSectors>=nb)
+		{
+			uint32_t first=FreeRuns[run].FirstSector;
+			fat32_take_from_free_run(run, nb);
+			return first;
+		}
+	}
+#endif
+	
+	uint32_t LoadedFATSector=0;
+	fat32_entry_t *entries=NULL;
+	uint32_t first=0;
+	uint32_t len=0;
+	uint32_t Sector;
+	
+	for(Sector=2; Sector<TotalNbOfDataSectors+2 && len<nb; Sector++)
+	{
+		pos_fat32_entry_t p=get_pos_fat_entry(Sector);
 		
-		EntryIndex=0;
+		if(p.FAT_SectorNumber!=LoadedFATSector)
+		{
+			entries=fat32_load_fat_sector(p.FAT_SectorNumber);
+			LoadedFATSector=p.FAT_SectorNumber;
+		}
+		
+		if(!fat32_is_free(entries, p.FAT_EntryIndex))
+			len=0;
+		else if(len++==0)
+			first=Sector;
 	}
 	
-	update_fsinfo();
+	if(len<nb)
+		return 0;
+	
+#if FS32_FREE_RUN_CACHE_SIZE
+	NbFreeRuns=0; //the cached runs might overlap with the sectors found here
+#endif
+	
+	return first;
+}
 
-	return p;
+static void fat32_release_sectors(const uint32_t new_last, const uint32_t first, const uint32_t last)
+{
+	//mark first...last as free and terminate the chain at new_last (if not 0), one FAT sector access per 128 entries
+	uint32_t sector=first;
+	
+	while(sector<=last)
+	{
+		pos_fat32_entry_t p=get_pos_fat_entry(sector);
+		fat32_entry_t *entries=fat32_load_fat_sector(p.FAT_SectorNumber);
+		
+		uint8_t EntryIndex;
+		for(EntryIndex=p.FAT_EntryIndex; EntryIndex<128 && sector<=last; EntryIndex++, sector++)
+			entries[EntryIndex]=0x00000000;
+		
+		fat32_store_fat_sector(p.FAT_SectorNumber);
+	}
+	
+	if(new_last)
+	{
+		pos_fat32_entry_t p_last=get_pos_fat_entry(new_last);
+		fat32_write_entry(&p_last, EndOfClusterChainMarker);
+	}
+	
+	NbFreeSectors+=last-first+1;
+	
+	update_fsinfo();
 }
 #endif
 
@@ -256,7 +715,7 @@ static bool create_dir_entry(ONLY_ARG_FILENR) //always in root-directory!
 	
 	while(!IS_EOC_MARKER(cl))
 	{
-		read_logical_sector(cl, Buffer);
+		read_logical_sector(cl, Buffer, FS32_IO_DIR);
 		
 		for(Index=0; Index<512/sizeof(fat32_directory_entry_t); Index++)
 		{
@@ -300,7 +759,7 @@ static bool create_dir_entry(ONLY_ARG_FILENR) //always in root-directory!
 	
 	memcpy(&(((fat32_directory_entry_t*)Buffer)[Index]), &DirEntry, sizeof(fat32_directory_entry_t));
 	
-	write_logical_sector(cl, Buffer);
+	write_logical_sector(cl, Buffer, FS32_IO_DIR);
 		
 	return false;
 }
@@ -309,7 +768,7 @@ static bool create_dir_entry(ONLY_ARG_FILENR) //always in root-directory!
 #if !FS32_NO_APPEND || !FS32_NO_MODIFY
 static void update_dir_entry(ONLY_ARG_FILENR)
 {
-	read_logical_sector(OpenFiles[FILENR_ARR_INDEX].SectorDirEntry, Buffer);
+	read_logical_sector(OpenFiles[FILENR_ARR_INDEX].SectorDirEntry, Buffer, FS32_IO_DIR);
 	
 	fat32_directory_entry_t * Entry=(fat32_directory_entry_t*)Buffer;
 	
@@ -317,7 +776,30 @@ static void update_dir_entry(ONLY_ARG_FILENR)
 	Entry[OpenFiles[FILENR_ARR_INDEX].IndexDirEntry].DIR_WrtTime=rtc_get_encoded_time();
 	Entry[OpenFiles[FILENR_ARR_INDEX].IndexDirEntry].DIR_WrtDate=rtc_get_encoded_date();
 	
-	write_logical_sector(OpenFiles[FILENR_ARR_INDEX].SectorDirEntry, Buffer);
+	write_logical_sector(OpenFiles[FILENR_ARR_INDEX].SectorDirEntry, Buffer, FS32_IO_DIR);
+}
+#endif
+
+#if !FS32_NO_APPEND || !FS32_NO_SEEK_TELL || FS32_LOOP_SUPPORT
+static uint32_t get_sector_of_pos(FIRST_ARG_FILENR const uint32_t pos)
+{
+	uint32_t NbSectors=pos/512;
+	
+	uint32_t sector=OpenFiles[FILENR_ARR_INDEX].FirstLogicalSector;
+	
+	if(OpenFiles[FILENR_ARR_INDEX].NbContiguousSectors)
+	{
+		uint32_t NbSkip=NbSectors;
+		if(NbSkip>OpenFiles[FILENR_ARR_INDEX].NbContiguousSectors-1)
+			NbSkip=OpenFiles[FILENR_ARR_INDEX].NbContiguousSectors-1;
+		sector+=NbSkip;
+		NbSectors-=NbSkip;
+	}
+	
+	while(NbSectors--)
+		sector=fat32_get_next_sector(sector);
+	
+	return sector;
 }
 #endif
 
@@ -329,15 +811,22 @@ static void set_file_pos(FIRST_ARG_FILENR uint32_t pos)
 	
 	OpenFiles[FILENR_ARR_INDEX].PosInFile=pos;
 	OpenFiles[FILENR_ARR_INDEX].PosInLogicalSector=pos%512;
+	OpenFiles[FILENR_ARR_INDEX].LogicalSector=get_sector_of_pos(FILENR_FIRST_FUNC_ARG pos);
+}
+#endif
+
+#if FS32_LOOP_SUPPORT
+static bool loop_wrap(ONLY_ARG_FILENR)
+{
+	//at the end of the loop reading continues at its start, the positions are at sector boundaries
+	if(!OpenFiles[FILENR_ARR_INDEX].LoopEnd || OpenFiles[FILENR_ARR_INDEX].PosInFile!=OpenFiles[FILENR_ARR_INDEX].LoopEnd)
+		return false;
 	
-	uint16_t NbSectors=pos/512;
-	
-	uint32_t sector=OpenFiles[FILENR_ARR_INDEX].FirstLogicalSector;
-	
-	while(NbSectors--)
-		sector=fat32_get_next_sector(sector);
+	OpenFiles[FILENR_ARR_INDEX].PosInFile=OpenFiles[FILENR_ARR_INDEX].LoopStart;
+	OpenFiles[FILENR_ARR_INDEX].PosInLogicalSector=0;
+	OpenFiles[FILENR_ARR_INDEX].LogicalSector=OpenFiles[FILENR_ARR_INDEX].LoopStartSector;
 	
-	OpenFiles[FILENR_ARR_INDEX].LogicalSector=sector;
+	return true;
 }
 #endif
 
@@ -367,6 +856,44 @@ static bool check_if_already_open(char const * const name)
 	return false;
 }
 
+static FS32_status_t get_slot_for_open(uint8_t * const filenr, char const * const filename)
+{
+	if(check_if_already_open(filename))
+		return OPEN_FILE_ALREADY_OPEN;
+	
+#if !SINGLE_FILE_CONFIG	
+	int8_t slot=get_free_slot();
+	if(slot<0)
+		return OPEN_NO_FREE_SLOT;
+		
+	(*filenr)=(uint8_t)slot;
+#else
+	(void)filenr;
+	if(OpenFiles[FILENR_ARR_INDEX].isInUse)
+		return OPEN_NO_FREE_SLOT;
+#endif
+
+	return STATUS_OK;
+}
+
+#if !FS32_NO_READ
+static void set_open_for_reading(FIRST_ARG_FILENR char const * const filename)
+{
+	OpenFiles[FILENR_ARR_INDEX].isInUse=true;
+	OpenFiles[FILENR_ARR_INDEX].isNewFile=false;
+	OpenFiles[FILENR_ARR_INDEX].OpenedForReading=true;
+	OpenFiles[FILENR_ARR_INDEX].OpenendForAppending=false;
+	OpenFiles[FILENR_ARR_INDEX].OpenendForModify=false;
+	OpenFiles[FILENR_ARR_INDEX].PosInFile=0;
+	OpenFiles[FILENR_ARR_INDEX].PosInLogicalSector=0;
+#if FS32_LOOP_SUPPORT
+	OpenFiles[FILENR_ARR_INDEX].LoopEnd=0;
+#endif
+	strncpy(OpenFiles[FILENR_ARR_INDEX].Name, filename, 8+1+3);
+	OpenFiles[FILENR_ARR_INDEX].Name[8+1+3]='\0';
+}
+#endif
+
 //public functions
 
 #if FS32_PARTITION_SUPPORT
@@ -375,6 +902,9 @@ FS32_status_t f_set_partition(const uint8_t partition)
 	if(partition>3)
 		return SET_PART_INVALID_NUMBER;
 	
+	STOP_READ_STREAM();
+	IO_STATS_COUNT(Reads, FS32_IO_BOOT);
+	BufferLogicalSector=0;
 	sd_read_sector(0, Buffer);
 	master_boot_record_t *mbr=(master_boot_record_t*)Buffer;
 	
@@ -393,13 +923,21 @@ FS32_status_t f_set_partition(const uint8_t partition)
 }
 #endif
 
-FS32_status_t f_init(void)
+static FS32_status_t fs32_load_boot_sector(void)
 {
 	uint8_t i;
 	for(i=0; i<FS32_NB_FILES_MAX; i++)
 		OpenFiles[i].isInUse=false;
 	
-	SD_READ_SECTOR(0, Buffer);
+	BufferLogicalSector=0;
+	
+#if FS32_FAT_CACHE
+	FATCacheSector=0;
+	FATCacheDirty=false;
+	FSInfoDirty=false;
+#endif
+	
+	SD_READ_SECTOR(FS32_IO_BOOT, 0, Buffer);
 	
 	fat32_header_t *header=(fat32_header_t*)Buffer;
 	
@@ -426,14 +964,22 @@ FS32_status_t f_init(void)
 	FATSz32=header->BPB_FATSz32;
 	FirstDataSector=header->BPB_RsvdSecCnt+header->BPB_FATSz32;
 	TotalNbOfDataSectors=header->BPB_TotSec32-FirstDataSector;
-	FATIndexLastEntry=TotalNbOfDataSectors%128;
+#if FS32_BOOT_CACHE_SUPPORT
+	VolumeID=header->BS_VolID;
+#endif
 	
-	//FAT EOC-Marker
-	sd_read_sector(header->BPB_RsvdSecCnt, Buffer);
+	return STATUS_OK;
+}
+
+static void fs32_load_eoc_marker(void)
+{
+	SD_READ_SECTOR(FS32_IO_FAT, RsvdSecCnt, Buffer);
 	EndOfClusterChainMarker=((fat32_entry_t*)Buffer)[1];
-	
-	//FSINFO
-	SD_READ_SECTOR(1, Buffer);
+}
+
+static FS32_status_t fs32_load_fsinfo(void)
+{
+	SD_READ_SECTOR(FS32_IO_FSINFO, 1, Buffer);
 	fat32_fsinfo_t *fsinfo=(fat32_fsinfo_t*)Buffer;
 	
 	if(fsinfo->FSI_LeadSig!=FSI_LEADSIG)
@@ -442,25 +988,123 @@ FS32_status_t f_init(void)
 	NbFreeSectors=fsinfo->FSI_Free_Count;
 	LastAllocatedSector=fsinfo->FSI_Last_Allocated;
 	
+#if FS32_FREE_RUN_CACHE_SIZE
+	NbFreeRuns=0;
+	FreeRunScanPos=LastAllocatedSector+1;
+#endif
+	
 	return STATUS_OK;
 }
 
-FS32_status_t f_open(uint8_t * const filenr, char const * const filename, const char mode)
+FS32_status_t f_init(void)
 {
-	if(check_if_already_open(filename))
-		return OPEN_FILE_ALREADY_OPEN;
+	FS32_status_t status=fs32_load_boot_sector();
+	if(status)
+		return status;
 	
-#if !SINGLE_FILE_CONFIG	
-	int8_t slot=get_free_slot();
-	if(slot<0)
-		return OPEN_NO_FREE_SLOT;
+	fs32_load_eoc_marker();
+	
+	return fs32_load_fsinfo();
+}
+
+#if FS32_BOOT_CACHE_SUPPORT
+FS32_status_t f_init_cached(FS32_volume_cache_t * const cache)
+{
+	//the boot sector must be read anyway to know if this is still the same card
+	FS32_status_t status=fs32_load_boot_sector();
+	if(status)
+		return status;
+	
+	if(cache->Valid!=FS32_CACHE_VALID || cache->VolumeID!=VolumeID)
+	{
+		fs32_load_eoc_marker();
+		status=fs32_load_fsinfo();
+		if(status)
+			return status;
 		
-	(*filenr)=(uint8_t)slot;
+		cache->Valid=FS32_CACHE_VALID;
+		cache->VolumeID=VolumeID;
+		cache->EndOfClusterChainMarker=EndOfClusterChainMarker;
+		cache->NbFreeSectors=NbFreeSectors;
+		cache->LastAllocatedSector=LastAllocatedSector;
+		
+		return STATUS_OK;
+	}
+	
+	EndOfClusterChainMarker=cache->EndOfClusterChainMarker;
+	
+#if FS32_NO_WRITE && FS32_NO_APPEND
+	//nothing is allocated, the free count is only informational and may be outdated
+	NbFreeSectors=cache->NbFreeSectors;
+	LastAllocatedSector=cache->LastAllocatedSector;
+	return STATUS_OK;
 #else
-	(void)filenr;
-	if(OpenFiles[FILENR_ARR_INDEX].isInUse)
-		return OPEN_NO_FREE_SLOT;
+	return fs32_load_fsinfo();
 #endif
+}
+
+FS32_status_t f_open_cached(uint8_t * const filenr, char const * const filename, FS32_file_cache_t * const cache)
+{
+	FS32_status_t status=get_slot_for_open(filenr, filename);
+	if(status)
+		return status;
+	
+	if(cache->Valid==FS32_CACHE_VALID && cache->VolumeID==VolumeID && cache->IndexDirEntry<512/sizeof(fat32_directory_entry_t))
+	{
+		//only read the directory entry we know to make sure the file has not been changed, no search
+		read_logical_sector(cache->SectorDirEntry, Buffer, FS32_IO_DIR);
+		fat32_directory_entry_t const * const entry=&(((fat32_directory_entry_t*)Buffer)[cache->IndexDirEntry]);
+		
+		//a file rewritten in the same place with the same size may be fragmented differently, only the time of the last write tells
+		if((uint8_t)entry->DIR_Name[0]!=DIR_ENTRY_FREE && (uint8_t)entry->DIR_Name[0]!=DIR_ENTRY_FREE_NO_MORE_DIR && ((((uint32_t)entry->DIR_FstClusHI<<16)|entry->DIR_FstClusLO)==cache->FirstLogicalSector) && entry->DIR_FileSize==cache->FileSize
+			&& !memcmp(entry->DIR_Name, cache->Name, 8) && !memcmp(entry->DIR_Ext, &cache->Name[8], 3) && entry->DIR_WrtTime==cache->WrtTime && entry->DIR_WrtDate==cache->WrtDate)
+		{
+			OpenFiles[FILENR_PTR_ARR_INDEX].FileFound=true;
+			OpenFiles[FILENR_PTR_ARR_INDEX].FirstLogicalSector=cache->FirstLogicalSector;
+			OpenFiles[FILENR_PTR_ARR_INDEX].LogicalSector=cache->FirstLogicalSector;
+			OpenFiles[FILENR_PTR_ARR_INDEX].FileSize=cache->FileSize;
+			OpenFiles[FILENR_PTR_ARR_INDEX].NbContiguousSectors=cache->NbContiguousSectors;
+			OpenFiles[FILENR_PTR_ARR_INDEX].SectorDirEntry=cache->SectorDirEntry;
+			OpenFiles[FILENR_PTR_ARR_INDEX].IndexDirEntry=cache->IndexDirEntry;
+			set_open_for_reading(FILENR_PTR_FUNC_ARG filename);
+			
+			return STATUS_OK;
+		}
+	}
+	
+	status=f_open(filenr, filename, 'r');
+	if(status)
+		return status;
+	
+	//learn how much of the file is contiguous, reading this part never needs the FAT again
+	uint32_t NbSectors=OpenFiles[FILENR_PTR_ARR_INDEX].FileSize/512+(OpenFiles[FILENR_PTR_ARR_INDEX].FileSize%512?1:0);
+	if(NbSectors && OpenFiles[FILENR_PTR_ARR_INDEX].FirstLogicalSector)
+		OpenFiles[FILENR_PTR_ARR_INDEX].NbContiguousSectors=fat32_count_contiguous(OpenFiles[FILENR_PTR_ARR_INDEX].FirstLogicalSector, NbSectors);
+	
+	cache->Valid=FS32_CACHE_VALID;
+	cache->VolumeID=VolumeID;
+	cache->FirstLogicalSector=OpenFiles[FILENR_PTR_ARR_INDEX].FirstLogicalSector;
+	cache->FileSize=OpenFiles[FILENR_PTR_ARR_INDEX].FileSize;
+	cache->NbContiguousSectors=OpenFiles[FILENR_PTR_ARR_INDEX].NbContiguousSectors;
+	cache->SectorDirEntry=OpenFiles[FILENR_PTR_ARR_INDEX].SectorDirEntry;
+	cache->IndexDirEntry=OpenFiles[FILENR_PTR_ARR_INDEX].IndexDirEntry;
+	
+	read_logical_sector(cache->SectorDirEntry, Buffer, FS32_IO_DIR);
+	fat32_directory_entry_t const * const entry=&(((fat32_directory_entry_t*)Buffer)[cache->IndexDirEntry]);
+	memcpy(cache->Name, entry->DIR_Name, 8);
+	memcpy(&cache->Name[8], entry->DIR_Ext, 3);
+	cache->WrtTime=entry->DIR_WrtTime;
+	cache->WrtDate=entry->DIR_WrtDate;
+	
+	return STATUS_OK;
+}
+#endif
+
+FS32_status_t f_open(uint8_t * const filenr, char const * const filename, const char mode)
+{
+	FS32_status_t status=get_slot_for_open(filenr, filename);
+	if(status)
+		return status;
 
 	fat32_search_for_file(FILENR_PTR_FUNC_ARG filename);
 	
@@ -470,10 +1114,7 @@ FS32_status_t f_open(uint8_t * const filenr, char const * const filename, const
 		if(OpenFiles[FILENR_PTR_ARR_INDEX].FileFound==false)
 			return OPEN_FILE_NOT_FOUND;
 		
-		OpenFiles[FILENR_PTR_ARR_INDEX].isNewFile=false;
-		OpenFiles[FILENR_PTR_ARR_INDEX].OpenedForReading=true;
-		OpenFiles[FILENR_PTR_ARR_INDEX].PosInFile=0;
-		OpenFiles[FILENR_PTR_ARR_INDEX].PosInLogicalSector=0;
+		set_open_for_reading(FILENR_PTR_FUNC_ARG filename);
 	}
 	else
 #endif
@@ -494,6 +1135,7 @@ FS32_status_t f_open(uint8_t * const filenr, char const * const filename, const
 			OpenFiles[FILENR_PTR_ARR_INDEX].isNewFile=true;
 			OpenFiles[FILENR_PTR_ARR_INDEX].FirstLogicalSector=FATEntry.LogicalSector;
 			OpenFiles[FILENR_PTR_ARR_INDEX].LogicalSector=FATEntry.LogicalSector;
+			OpenFiles[FILENR_PTR_ARR_INDEX].NbContiguousSectors=1;
 			
 			strncpy(OpenFiles[FILENR_PTR_ARR_INDEX].Name, filename, 8+1+3);
 			
@@ -542,11 +1184,29 @@ FS32_status_t f_close(const uint8_t filenr)
 	(void)filenr;
 #endif
 
+	STOP_READ_STREAM(); //the card is free for other uses after closing a file
+	
 	if(!OpenFiles[FILENR_ARR_INDEX].isInUse)
 		return STATUS_OK;
 	
 	OpenFiles[FILENR_ARR_INDEX].isInUse=false;
 	
+#if FS32_PREALLOC_SUPPORT
+	if(OpenFiles[FILENR_ARR_INDEX].isNewFile)
+	{
+		//give back preallocated sectors that were not used
+		uint32_t NbUsed=OpenFiles[FILENR_ARR_INDEX].FileSize/512+(OpenFiles[FILENR_ARR_INDEX].FileSize%512?1:0);
+		if(NbUsed==0)
+			NbUsed=1;
+		if(OpenFiles[FILENR_ARR_INDEX].NbContiguousSectors>NbUsed)
+		{
+			uint32_t LastUsed=OpenFiles[FILENR_ARR_INDEX].FirstLogicalSector+NbUsed-1;
+			fat32_release_sectors(LastUsed, LastUsed+1, OpenFiles[FILENR_ARR_INDEX].FirstLogicalSector+OpenFiles[FILENR_ARR_INDEX].NbContiguousSectors-1);
+			OpenFiles[FILENR_ARR_INDEX].NbContiguousSectors=NbUsed;
+		}
+	}
+#endif
+
 #if !FS32_NO_WRITE	
 	if(OpenFiles[FILENR_ARR_INDEX].isNewFile)
 	{
@@ -561,9 +1221,55 @@ FS32_status_t f_close(const uint8_t filenr)
 		update_dir_entry(FILENR_ONLY_FUNC_ARG);
 	}
 #endif
+
+#if FS32_FAT_CACHE && (!FS32_NO_APPEND || !FS32_NO_WRITE)
+	fs32_sync();
+#endif
+	
+	return STATUS_OK;
+}
+
+#if FS32_FAT_CACHE && (!FS32_NO_APPEND || !FS32_NO_WRITE)
+FS32_status_t f_sync(void)
+{
+	fs32_sync();
+	
+	return STATUS_OK;
+}
+#endif
+
+#if FS32_PREALLOC_SUPPORT
+FS32_status_t f_prealloc(const uint8_t filenr, const uint32_t bytes)
+{
+	
+#if SINGLE_FILE_CONFIG
+	(void)filenr;
+#endif
+
+	if(!OpenFiles[FILENR_ARR_INDEX].isInUse || !OpenFiles[FILENR_ARR_INDEX].isNewFile || OpenFiles[FILENR_ARR_INDEX].FileSize)
+		return PREALLOC_NOT_EMPTY_NEW_FILE;
+	
+	uint32_t NbSectors=bytes/512+(bytes%512?1:0);
+	if(NbSectors==0)
+		NbSectors=1;
+	
+	uint32_t First=fat32_find_contiguous_free(NbSectors);
+	if(!First)
+		return PREALLOC_NO_CONTIGUOUS_SPACE;
+	
+	fat32_link_run(0, First, NbSectors);
+	
+	//the sector allocated by f_open() is not needed anymore
+	fat32_release_sectors(0, OpenFiles[FILENR_ARR_INDEX].FirstLogicalSector, OpenFiles[FILENR_ARR_INDEX].FirstLogicalSector);
+	
+	OpenFiles[FILENR_ARR_INDEX].FirstLogicalSector=First;
+	OpenFiles[FILENR_ARR_INDEX].LogicalSector=First;
+	OpenFiles[FILENR_ARR_INDEX].PosInLogicalSector=0;
+	OpenFiles[FILENR_ARR_INDEX].NbContiguousSectors=NbSectors;
 	
 	return STATUS_OK;
 }
+#endif
 
 #if !FS32_NO_READ
 FS32_status_t f_read(const uint8_t filenr, void * ptr, const uint16_t size, const uint16_t n)
@@ -583,22 +1289,34 @@ FS32_status_t f_read(const uint8_t filenr, void * ptr, const uint16_t size, cons
 		if(NbToCopy>(OpenFiles[FILENR_ARR_INDEX].FileSize-OpenFiles[FILENR_ARR_INDEX].PosInFile))
 			NbToCopy=OpenFiles[FILENR_ARR_INDEX].FileSize-OpenFiles[FILENR_ARR_INDEX].PosInFile;
 
-		read_logical_sector(OpenFiles[FILENR_ARR_INDEX].LogicalSector, Buffer);
+		//small reads from the same sector are served from Buffer
+		if(OpenFiles[FILENR_ARR_INDEX].LogicalSector!=BufferLogicalSector)
+		{
+			read_logical_sector(OpenFiles[FILENR_ARR_INDEX].LogicalSector, Buffer, FS32_IO_DATA);
+			BufferLogicalSector=OpenFiles[FILENR_ARR_INDEX].LogicalSector;
+		}
 		
 		memcpy(ptr, Buffer+OpenFiles[FILENR_ARR_INDEX].PosInLogicalSector, NbToCopy);
 		
 		ptr+=NbToCopy;
 		OpenFiles[FILENR_ARR_INDEX].PosInFile+=NbToCopy;
 		OpenFiles[FILENR_ARR_INDEX].PosInLogicalSector+=NbToCopy;
+		NbBytesToRead-=NbToCopy; //before leaving the loop at the end of the chain, the bytes have been copied
 		if(OpenFiles[FILENR_ARR_INDEX].PosInLogicalSector>=512)
 		{
 			OpenFiles[FILENR_ARR_INDEX].PosInLogicalSector-=512;
-			OpenFiles[FILENR_ARR_INDEX].LogicalSector=fat32_get_next_sector(OpenFiles[FILENR_ARR_INDEX].LogicalSector);
+#if FS32_LOOP_SUPPORT
+			if(loop_wrap(FILENR_ONLY_FUNC_ARG))
+				continue;
+#endif
+			uint32_t NextIndex=OpenFiles[FILENR_ARR_INDEX].PosInFile/512;
+			if(NextIndex<OpenFiles[FILENR_ARR_INDEX].NbContiguousSectors)
+				OpenFiles[FILENR_ARR_INDEX].LogicalSector=OpenFiles[FILENR_ARR_INDEX].FirstLogicalSector+NextIndex;
+			else
+				OpenFiles[FILENR_ARR_INDEX].LogicalSector=fat32_get_next_sector(OpenFiles[FILENR_ARR_INDEX].LogicalSector);
 			if(OpenFiles[FILENR_ARR_INDEX].LogicalSector==EndOfClusterChainMarker)
 				break;
 		}
-		
-		NbBytesToRead-=NbToCopy;
 	}
 	
 	if(NbBytesToRead)
@@ -608,6 +1326,101 @@ FS32_status_t f_read(const uint8_t filenr, void * ptr, const uint16_t size, cons
 }
 #endif
 
+#if FS32_MULTI_BLOCK_READ_SUPPORT
+static uint32_t fat32_get_run_length(FIRST_ARG_FILENR const uint32_t sector, const uint32_t max)
+{
+	//number of sectors starting at sector that follow each other on the card, needs at most one FAT sector
+	uint32_t Index=(OpenFiles[FILENR_ARR_INDEX].PosInFile/512);
+	if(Index<OpenFiles[FILENR_ARR_INDEX].NbContiguousSectors)
+	{
+		uint32_t n=OpenFiles[FILENR_ARR_INDEX].NbContiguousSectors-Index;
+		return (n<max)?n:max;
+	}
+	
+	//stop before the entries of the next FAT sector would be needed
+	uint32_t MaxInFATSector=129-get_pos_fat_entry(sector).FAT_EntryIndex;
+	return fat32_count_contiguous(sector, (max<MaxInFATSector)?max:MaxInFATSector);
+}
+
+FS32_status_t f_read_sectors(const uint8_t filenr, uint8_t * const ring, const uint8_t nb_slots, const uint8_t first_slot, const uint8_t nb_sectors)
+{
+	
+#if SINGLE_FILE_CONFIG
+	(void)filenr;
+#endif
+
+	if(OpenFiles[FILENR_ARR_INDEX].PosInFile>=OpenFiles[FILENR_ARR_INDEX].FileSize)
+		return READ_FAILED;
+	
+	if(OpenFiles[FILENR_ARR_INDEX].PosInLogicalSector)
+		return READ_SECTORS_NOT_ALIGNED;
+	
+	uint8_t Slot=first_slot;
+	uint8_t NbLeft=nb_sectors;
+	
+	while(NbLeft)
+	{
+		if(OpenFiles[FILENR_ARR_INDEX].PosInFile>=OpenFiles[FILENR_ARR_INDEX].FileSize)
+			return READ_FAILED;
+		
+		uint32_t Sector=OpenFiles[FILENR_ARR_INDEX].LogicalSector;
+		
+		if(Sector!=ReadStreamNextSector)
+			fs32_stop_read_stream();
+		
+		if(!ReadStreamNbLeft)
+		{
+			//find the next run, if this needs the FAT from the card the multi-block read is ended and started again
+			uint32_t End=OpenFiles[FILENR_ARR_INDEX].FileSize;
+#if FS32_LOOP_SUPPORT
+			if(OpenFiles[FILENR_ARR_INDEX].LoopEnd)
+				End=OpenFiles[FILENR_ARR_INDEX].LoopEnd;
+#endif
+			uint32_t NbSectorsInFile=(End-OpenFiles[FILENR_ARR_INDEX].PosInFile+511)/512;
+			uint32_t RunLength=fat32_get_run_length(FILENR_FIRST_FUNC_ARG Sector, NbSectorsInFile);
+			if(!ReadStreamNextSector)
+			{
+				SD_READ_MULTIPLE_START(LOGICAL_SECTOR_TO_PHYSICAL(Sector));
+				ReadStreamNextSector=Sector;
+			}
+			ReadStreamNbLeft=RunLength;
+		}
+		
+		SD_READ_MULTIPLE_SECTOR(&ring[(uint16_t)Slot*512]);
+		ReadStreamNextSector++;
+		ReadStreamNbLeft--;
+		
+		if(++Slot==nb_slots)
+			Slot=0;
+		NbLeft--;
+		
+		if(OpenFiles[FILENR_ARR_INDEX].FileSize-OpenFiles[FILENR_ARR_INDEX].PosInFile<512)
+		{
+			//last sector of the file, stay there like f_read()
+			OpenFiles[FILENR_ARR_INDEX].PosInLogicalSector=OpenFiles[FILENR_ARR_INDEX].FileSize-OpenFiles[FILENR_ARR_INDEX].PosInFile;
+			OpenFiles[FILENR_ARR_INDEX].PosInFile=OpenFiles[FILENR_ARR_INDEX].FileSize;
+		}
+		else
+		{
+			OpenFiles[FILENR_ARR_INDEX].PosInFile+=512;
+#if FS32_LOOP_SUPPORT
+			if(loop_wrap(FILENR_ONLY_FUNC_ARG))
+				ReadStreamNbLeft=0; //the multi-block read goes on if the loop start happens to be the next sector on the card, else it is started again there
+			else
+#endif
+			if(ReadStreamNbLeft)
+				OpenFiles[FILENR_ARR_INDEX].LogicalSector=Sector+1;
+			else if(OpenFiles[FILENR_ARR_INDEX].PosInFile<OpenFiles[FILENR_ARR_INDEX].FileSize)
+				OpenFiles[FILENR_ARR_INDEX].LogicalSector=fat32_get_next_sector(Sector); //ends the multi-block read if the FAT must be read
+			else
+				OpenFiles[FILENR_ARR_INDEX].LogicalSector=EndOfClusterChainMarker;
+		}
+	}
+	
+	return STATUS_OK;
+}
+#endif
+
 #if !FS32_NO_APPEND || !FS32_NO_WRITE || !FS32_NO_MODIFY
 FS32_status_t f_write(const uint8_t filenr, void const * ptr, const uint16_t size, const uint16_t n)
 {
@@ -627,6 +1440,43 @@ FS32_status_t f_write(const uint8_t filenr, void const * ptr, const uint16_t siz
 	
 	while(NbBytesToWrite)
 	{
+#if FS32_MULTI_BLOCK_WRITE_SUPPORT
+		if(OpenFiles[FILENR_ARR_INDEX].PosInLogicalSector==0 && NbBytesToWrite>=512 && (OpenFiles[FILENR_ARR_INDEX].isNewFile || OpenFiles[FILENR_ARR_INDEX].OpenendForAppending))
+		{
+			//stream all whole sectors directly from ptr: either into the preallocated sectors or grow the chain as far as possible without fragmenting
+			uint32_t Index=OpenFiles[FILENR_ARR_INDEX].PosInFile/512;
+			uint32_t NbSectors;
+			if(Index+1<OpenFiles[FILENR_ARR_INDEX].NbContiguousSectors)
+			{
+				NbSectors=OpenFiles[FILENR_ARR_INDEX].NbContiguousSectors-Index;
+				if(NbSectors>NbBytesToWrite/512)
+					NbSectors=NbBytesToWrite/512;
+			}
+			else
+			{
+				NbSectors=1+fat32_extend_contiguous(OpenFiles[FILENR_ARR_INDEX].LogicalSector, NbBytesToWrite/512-1);
+				if(Index+1==OpenFiles[FILENR_ARR_INDEX].NbContiguousSectors)
+					OpenFiles[FILENR_ARR_INDEX].NbContiguousSectors+=NbSectors-1;
+			}
+			
+			BufferLogicalSector=0;
+			SD_WRITE_MULTIPLE_START(LOGICAL_SECTOR_TO_PHYSICAL(OpenFiles[FILENR_ARR_INDEX].LogicalSector), NbSectors);
+			uint32_t i;
+			for(i=0; i<NbSectors; i++)
+			{
+				SD_WRITE_MULTIPLE_SECTOR(ptr);
+				ptr+=512;
+			}
+			sd_write_multiple_stop();
+			
+			NbBytesToWrite-=NbSectors*512;
+			OpenFiles[FILENR_ARR_INDEX].PosInFile+=NbSectors*512;
+			OpenFiles[FILENR_ARR_INDEX].FileSize=OpenFiles[FILENR_ARR_INDEX].PosInFile;
+			OpenFiles[FILENR_ARR_INDEX].LogicalSector+=NbSectors-1;
+			OpenFiles[FILENR_ARR_INDEX].PosInLogicalSector=512; //next sector (if any) gets allocated below
+		}
+#endif
+		
 		uint16_t NbBytesToCopy=512-OpenFiles[FILENR_ARR_INDEX].PosInLogicalSector;
 		
 		bool IncreasingSize=false;
@@ -640,11 +1490,11 @@ FS32_status_t f_write(const uint8_t filenr, void const * ptr, const uint16_t siz
 		if(NbBytesToCopy) //avoid reading a sector just to write it again without change
 		{
 			if(OpenFiles[FILENR_ARR_INDEX].PosInLogicalSector!=0 || OpenFiles[FILENR_ARR_INDEX].OpenendForModify)
-				read_logical_sector(OpenFiles[FILENR_ARR_INDEX].LogicalSector, Buffer);
+				read_logical_sector(OpenFiles[FILENR_ARR_INDEX].LogicalSector, Buffer, FS32_IO_DATA);
 			
 			memcpy(Buffer+OpenFiles[FILENR_ARR_INDEX].PosInLogicalSector, ptr, NbBytesToCopy);
 			
-			write_logical_sector(OpenFiles[FILENR_ARR_INDEX].LogicalSector, Buffer);
+			write_logical_sector(OpenFiles[FILENR_ARR_INDEX].LogicalSector, Buffer, FS32_IO_DATA);
 
 			NbBytesToWrite-=NbBytesToCopy;
 			ptr+=NbBytesToCopy;
@@ -674,7 +1524,14 @@ FS32_status_t f_write(const uint8_t filenr, void const * ptr, const uint16_t siz
 			}
 #endif
 			
-			if(OpenFiles[FILENR_ARR_INDEX].OpenendForAppending || OpenFiles[FILENR_ARR_INDEX].isNewFile || NeedMoreSpace)
+			uint32_t NextIndex=OpenFiles[FILENR_ARR_INDEX].PosInFile/512;
+			
+			if(NextIndex<OpenFiles[FILENR_ARR_INDEX].NbContiguousSectors) //already allocated, no need to look into the FAT
+			{
+				OpenFiles[FILENR_ARR_INDEX].LogicalSector=OpenFiles[FILENR_ARR_INDEX].FirstLogicalSector+NextIndex;
+				OpenFiles[FILENR_ARR_INDEX].PosInLogicalSector=0;
+			}
+			else if(OpenFiles[FILENR_ARR_INDEX].OpenendForAppending || OpenFiles[FILENR_ARR_INDEX].isNewFile || NeedMoreSpace)
 			{
 				pos_fat32_entry_t p_curr=get_pos_fat_entry(OpenFiles[FILENR_ARR_INDEX].LogicalSector);
 				pos_fat32_entry_t p_new=fat32_get_next_free_entry();
@@ -682,6 +1539,8 @@ FS32_status_t f_write(const uint8_t filenr, void const * ptr, const uint16_t siz
 					return WRITE_NO_MORE_SPACE;
 				fat32_write_entry(&p_curr, p_new.LogicalSector);
 				fat32_write_entry(&p_new, EndOfClusterChainMarker);
+				if(NextIndex==OpenFiles[FILENR_ARR_INDEX].NbContiguousSectors && p_new.LogicalSector==OpenFiles[FILENR_ARR_INDEX].FirstLogicalSector+NextIndex)
+					OpenFiles[FILENR_ARR_INDEX].NbContiguousSectors++;
 				OpenFiles[FILENR_ARR_INDEX].LogicalSector=p_new.LogicalSector;
 				OpenFiles[FILENR_ARR_INDEX].PosInLogicalSector=0;
 			}
@@ -692,6 +1551,35 @@ FS32_status_t f_write(const uint8_t filenr, void const * ptr, const uint16_t siz
 }
 #endif
 
+#if FS32_LOOP_SUPPORT
+FS32_status_t f_loop(const uint8_t filenr, const uint32_t start, const uint32_t end)
+{
+	
+#if SINGLE_FILE_CONFIG
+	(void)filenr;
+#endif
+
+	if(!OpenFiles[FILENR_ARR_INDEX].OpenedForReading)
+		return LOOP_CANT_LOOP_IN_THIS_MODE;
+	
+	//end==0 switches looping off
+	if(end==0)
+	{
+		OpenFiles[FILENR_ARR_INDEX].LoopEnd=0;
+		return STATUS_OK;
+	}
+	
+	if(start%512 || end%512 || start>=end || end>OpenFiles[FILENR_ARR_INDEX].FileSize || OpenFiles[FILENR_ARR_INDEX].PosInFile>end)
+		return LOOP_INVALID_POS;
+	
+	OpenFiles[FILENR_ARR_INDEX].LoopStartSector=get_sector_of_pos(FILENR_FIRST_FUNC_ARG start);
+	OpenFiles[FILENR_ARR_INDEX].LoopStart=start;
+	OpenFiles[FILENR_ARR_INDEX].LoopEnd=end;
+	
+	return STATUS_OK;
+}
+#endif
+
 #if !FS32_NO_SEEK_TELL
 FS32_status_t f_seek(const uint8_t filenr, const uint32_t pos)
 {
@@ -737,6 +1625,15 @@ uint32_t get_file_size(const uint8_t filenr)
 	return OpenFiles[FILENR_ARR_INDEX].FileSize;
 }
 
+#if FS32_IO_STATS
+void f_stats(FS32_stats_t * const stats)
+{
+	//counters since the last call
+	memcpy(stats, &IOStats, sizeof(FS32_stats_t));
+	memset(&IOStats, 0, sizeof(FS32_stats_t));
+}
+#endif
+
 #if !FS32_NO_FILE_LISTING
 FS32_status_t f_ls(const f_ls_callback callback)
 {
@@ -749,7 +1646,7 @@ FS32_status_t f_ls(const f_ls_callback callback)
 		
 		bool NoMoreEntries=false;
 		
-		read_logical_sector(cl, Buffer);
+		read_logical_sector(cl, Buffer, FS32_IO_DIR);
 		
 		for(NbEntry=0; NbEntry<512/sizeof(fat32_directory_entry_t); NbEntry++)
 		{
@@ -764,8 +1661,8 @@ FS32_status_t f_ls(const f_ls_callback callback)
 				break;
 			}
 			
-			if(DirEntry.DIR_Attr&ATTR_LONG_NAME) //UNSUPPORTED!
-				return LS_LONG_NAME;
+			if(IS_LONG_NAME_ENTRY(DirEntry.DIR_Attr)) //only the short name is reported
+				continue;
 			
 			char Filename[8+1+3+1];
 			fat32_filename_to_string(&DirEntry, Filename);
@@ -42,6 +42,7 @@ typedef enum
 	OPEN_INVALID_MODE,
 	
 	READ_FAILED,
+	READ_SECTORS_NOT_ALIGNED,
 	
 	WRITE_NO_OPEN_FILE,
 	WRITE_FILE_READ_ONLY,
@@ -53,22 +54,77 @@ typedef enum
 	SEEK_CANT_SEEK_IN_THIS_MODE,
 	SEEK_INVALID_POS,
 	
-	LS_LONG_NAME,
+	PREALLOC_NOT_EMPTY_NEW_FILE,
+	PREALLOC_NO_CONTIGUOUS_SPACE,
+	
+	LOOP_CANT_LOOP_IN_THIS_MODE,
+	LOOP_INVALID_POS,
 	
 } FS32_status_t;
 
 typedef void (*f_ls_callback)(char const * const file);
 
+//for f_init_cached() and f_open_cached(), store these somewhere non-volatile (EEPROM) and give them back at the next start
+#define FS32_CACHE_VALID 0xA5
+
+typedef struct
+{
+	uint8_t Valid; //FS32_CACHE_VALID if filled by kittenFS32
+	uint32_t VolumeID;
+	uint32_t EndOfClusterChainMarker;
+	uint32_t NbFreeSectors;
+	uint32_t LastAllocatedSector;
+} FS32_volume_cache_t;
+
+typedef struct
+{
+	uint8_t Valid; //FS32_CACHE_VALID if filled by kittenFS32
+	uint32_t VolumeID;
+	uint32_t FirstLogicalSector;
+	uint32_t FileSize;
+	uint32_t NbContiguousSectors; //from the start of the file
+	uint32_t SectorDirEntry;
+	uint8_t IndexDirEntry;
+	char Name[11]; //8.3 name of the directory entry, with the time of the last write it tells a renamed or rewritten file
+	uint16_t WrtTime;
+	uint16_t WrtDate;
+} FS32_file_cache_t;
+
+//classes of sectors for f_stats()
+typedef enum
+{
+	FS32_IO_BOOT=0, //MBR and boot sector
+	FS32_IO_FSINFO,
+	FS32_IO_FAT,
+	FS32_IO_DIR,
+	FS32_IO_DATA,
+	
+	FS32_IO_NB_CLASSES
+} FS32_io_class_t;
+
+typedef struct
+{
+	uint32_t Reads[FS32_IO_NB_CLASSES]; //sectors read from the card, index is FS32_io_class_t
+	uint32_t Writes[FS32_IO_NB_CLASSES]; //sectors written to the card, multi-block writes count each sector
+} FS32_stats_t;
+
 FS32_status_t f_set_partition(const uint8_t partition);
 FS32_status_t f_init(void);
+FS32_status_t f_init_cached(FS32_volume_cache_t * const cache);
 FS32_status_t f_open(uint8_t * const filenr, char const * const filename, const char mode);
+FS32_status_t f_open_cached(uint8_t * const filenr, char const * const filename, FS32_file_cache_t * const cache);
 FS32_status_t f_close(const uint8_t filenr);
+FS32_status_t f_sync(void);
 FS32_status_t f_read(const uint8_t filenr, void * ptr, const uint16_t size, const uint16_t n);
+FS32_status_t f_read_sectors(const uint8_t filenr, uint8_t * const ring, const uint8_t nb_slots, const uint8_t first_slot, const uint8_t nb_sectors);
 FS32_status_t f_write(const uint8_t filenr, void const * ptr, const uint16_t size, const uint16_t n);
+FS32_status_t f_prealloc(const uint8_t filenr, const uint32_t bytes);
+FS32_status_t f_loop(const uint8_t filenr, const uint32_t start, const uint32_t end);
 FS32_status_t f_seek(const uint8_t filenr, const uint32_t pos);
 uint32_t f_tell(const uint8_t filenr);
 uint32_t get_free_sectors_count(void);
 uint32_t get_file_size(const uint8_t filenr);
 FS32_status_t f_ls(const f_ls_callback callback);
+void f_stats(FS32_stats_t * const stats);
 
 #endif
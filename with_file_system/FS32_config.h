@@ -21,12 +21,36 @@ FS32_NO_SEEK_TELL == 1 removes f_seek() and f_tell()
 
 FS32_NO_FILE_LISTING == 1 removes f_ls()
 
+FS32_NO_LONG_NAMES == 1 removes matching of long file names (VFAT) in f_open(). Files are then found by their short name (8.3) only. Long name entries are always skipped.
+
 FS32_PARTITION_SUPPORT == 1 adds support for partitions (type MBR primary only)
 
+FS32_MULTI_BLOCK_WRITE_SUPPORT == 1 makes f_write() stream whole sectors to the card with a single multi-block write (CMD25) when growing a file and allocate the corresponding sectors with one FAT-sector update per 128 sectors. You need to provide sd_write_multiple_start(), sd_write_multiple_sector() and sd_write_multiple_stop() for this.
+
+FS32_MULTI_BLOCK_READ_SUPPORT == 1 adds f_read_sectors() that reads whole sectors directly into a ring of 512 byte slots provided by the caller. Contiguous sectors are read with a single multi-block read (CMD18) that stays open between calls, the card is only addressed again when the file is fragmented, when the FAT is needed (at most once per 128 sectors) or when there is another access to the card. You need to provide sd_read_multiple_start(), sd_read_multiple_sector() and sd_read_multiple_stop() for this. Don't access the card yourself before f_close() of the file you read with f_read_sectors().
+
+FS32_BOOT_CACHE_SUPPORT == 1 adds f_init_cached() and f_open_cached() for a faster start. They do the same as f_init() and f_open(..., 'r') but fill a small structure you should store (EEPROM) and give back at the next start. If the volume ID in the boot sector is still the same only the boot sector (and FSInfo if writing is enabled) is read, and instead of searching the directory only the known directory entry is read to check that the file is still the same (name, first cluster, size and time of the last write). The contiguous part of the file is remembered too, so reading it never needs the FAT.
+
 If MODIFY is enabled FS32_NO_WRITE must be 0 (WRITE enabled).
 
+FS32_FAT_CACHE == 1 adds a second buffer of 512 bytes that holds the current FAT sector. Modified FAT entries and FSInfo are only written back to the card when another FAT sector is needed, on f_close() or on f_sync(). This saves a lot of card accesses when writing (and reading) but data written since the last f_close() or f_sync() is lost on power failure. f_sync() only exists if this option is enabled.
+
+FS32_FREE_RUN_CACHE_SIZE != 0 keeps a list of up to this many extents of free sectors (8 bytes of RAM each). The list is filled by a single scan of the FAT when it runs empty, so allocating a sector does not need to search the FAT anymore and free sectors are handed out contiguously whenever possible.
+
+FS32_PREALLOC_SUPPORT == 1 adds f_prealloc() to reserve a contiguous run of sectors for a new file right after f_open('w') and before the first f_write(). Writing, reading and seeking inside this run does not need the FAT. Sectors not used are given back on f_close().
+
+FS32_LOOP_SUPPORT == 1 adds f_loop() to make reading a file continue at a start position whenever it reaches an end position, for both f_read() and f_read_sectors(). Both positions must be at sector boundaries. The sector of the start is looked up once by f_loop(), so going back never needs the FAT or f_seek().
+
+FS32_IO_STATS == 1 counts every sector read from and written to the card, separately for boot sector/MBR, FSInfo, FAT, directory and data (80 bytes of RAM). f_stats() returns the counters since its last call, so calling it before and after an operation gives the cost of this operation.
+
 If APPEND and/or MODIFY is enabled FS32_NO_SEEK_TELL must be 0 (SEEK_TELL enabled).
 
+If MULTI_BLOCK_WRITE or the FREE_RUN_CACHE is enabled WRITE and/or APPEND must be enabled.
+
+If PREALLOC is enabled WRITE must be enabled.
+
+If MULTI_BLOCK_READ, BOOT_CACHE or LOOP is enabled READ must be enabled.
+
 (c) 2021-2022 by kittennbfive
 
 version 0.06 - 17.04.22
@@ -48,7 +72,33 @@ AGPLv3+ and NO WARRANTY!
 
 #define FS32_NO_FILE_LISTING 1
 
+#define FS32_NO_LONG_NAMES 0
+
 //disabled by default
 #define FS32_PARTITION_SUPPORT 0
 
+//disabled by default
+#define FS32_MULTI_BLOCK_WRITE_SUPPORT 0
+
+//disabled by default
+#define FS32_MULTI_BLOCK_READ_SUPPORT 0
+
+//disabled by default, needs 512 bytes of RAM
+#define FS32_FAT_CACHE 0
+
+//disabled by default
+#define FS32_FREE_RUN_CACHE_SIZE 0
+
+//disabled by default
+#define FS32_PREALLOC_SUPPORT 0
+
+//disabled by default
+#define FS32_BOOT_CACHE_SUPPORT 0
+
+//disabled by default
+#define FS32_LOOP_SUPPORT 0
+
+//disabled by default
+#define FS32_IO_STATS 0
+
 #endif
@@ -111,6 +111,25 @@ typedef struct __attribute__((__packed__))
 #define ATTR_DIRECTORY 0x10
 #define ATTR_ARCHIVE 0x20
 #define ATTR_LONG_NAME (ATTR_READ_ONLY|ATTR_HIDDEN|ATTR_SYSTEM|ATTR_VOLUME_ID)
+#define ATTR_LONG_NAME_MASK (ATTR_READ_ONLY|ATTR_HIDDEN|ATTR_SYSTEM|ATTR_VOLUME_ID|ATTR_DIRECTORY|ATTR_ARCHIVE)
+
+#define IS_LONG_NAME_ENTRY(attr) (((attr)&ATTR_LONG_NAME_MASK)==ATTR_LONG_NAME)
+
+//VFAT long name entry, stored in front of the short entry it belongs to
+typedef struct __attribute__((__packed__))
+{
+	uint8_t LDIR_Ord;
+	uint16_t LDIR_Name1[5]; //UCS-2
+	uint8_t LDIR_Attr; //always ATTR_LONG_NAME
+	uint8_t LDIR_Type;
+	uint8_t LDIR_Chksum; //checksum of the short name
+	uint16_t LDIR_Name2[6];
+	uint16_t LDIR_FstClusLO; //always 0
+	uint16_t LDIR_Name3[2];
+} fat32_lfn_entry_t;
+
+#define LFN_LAST_LONG_ENTRY 0x40
+#define LFN_ORD_MASK 0x1F
 
 #define DIR_ENTRY_FREE 0xE5
 #define DIR_ENTRY_FREE_NO_MORE_DIR 0x00
@@ -125,6 +144,12 @@ typedef struct
 	uint8_t FAT_EntryIndex;
 } pos_fat32_entry_t;
 
+typedef struct
+{
+	uint32_t FirstSector;
+	uint32_t NbSectors;
+} free_run_t;
+
 typedef struct
 {	
 	bool FileFound;
@@ -137,6 +162,7 @@ typedef struct
 	char Name[8+1+3+1];
 	
 	uint32_t FirstLogicalSector;
+	uint32_t NbContiguousSectors; //number of sectors at the beginning of the file that are known to be contiguous, 0 if unknown
 	
 	uint32_t LogicalSector;
 	uint32_t PosInLogicalSector;
@@ -146,6 +172,12 @@ typedef struct
 	
 	uint32_t SectorDirEntry;
 	uint32_t IndexDirEntry;
+	
+#if FS32_LOOP_SUPPORT
+	uint32_t LoopStart; //positions given to f_loop(), LoopEnd==0 if the file doesn't loop
+	uint32_t LoopEnd;
+	uint32_t LoopStartSector; //logical sector of LoopStart
+#endif
 } file_t;
 
 //Some sanity checks on the configuration options and some internal defines depending on those options
@@ -166,6 +198,34 @@ typedef struct
 #error To modify files or append to files you need f_seek enabled.
 #endif
 
+#if FS32_MULTI_BLOCK_WRITE_SUPPORT && FS32_NO_WRITE && FS32_NO_APPEND
+#error Multi-block write is only useful if you enable write and/or append.
+#endif
+
+#if FS32_FREE_RUN_CACHE_SIZE && FS32_NO_WRITE && FS32_NO_APPEND
+#error The free run cache is only useful if you enable write and/or append.
+#endif
+
+#if FS32_MULTI_BLOCK_READ_SUPPORT && FS32_NO_READ
+#error Multi-block read needs read-functionality enabled.
+#endif
+
+#if FS32_BOOT_CACHE_SUPPORT && FS32_NO_READ
+#error The boot cache needs read-functionality enabled.
+#endif
+
+#if FS32_LOOP_SUPPORT && FS32_NO_READ
+#error Looping needs read-functionality enabled.
+#endif
+
+#if FS32_PREALLOC_SUPPORT && FS32_NO_WRITE
+#error Preallocation needs write-functionality enabled.
+#endif
+
+#if FS32_FREE_RUN_CACHE_SIZE>255
+#error FS32_FREE_RUN_CACHE_SIZE is too big.
+#endif
+
 #if FS32_NB_FILES_MAX>1
 #define FIRST_ARG_FILENR const uint8_t filenr,
 #define ONLY_ARG_FILENR const uint8_t filenr
@@ -185,17 +245,47 @@ typedef struct
 #define FILENR_PTR_FUNC_ARG
 #endif
 
+#if FS32_IO_STATS
+#define IO_STATS_COUNT(Counters, Class) IOStats.Counters[Class]++
+#else
+#define IO_STATS_COUNT(Counters, Class) (void)(Class)
+#endif
+
+//every other access to the card must end an open multi-block read first
+#if FS32_MULTI_BLOCK_READ_SUPPORT
+#define STOP_READ_STREAM() fs32_stop_read_stream()
+#else
+#define STOP_READ_STREAM()
+#endif
+
+//Class is FS32_IO_xxx and selects the counter for f_stats()
 #if FS32_PARTITION_SUPPORT
-#define SD_READ_SECTOR(Sector, Buffer) sd_read_sector((StartOfPartition+Sector), Buffer)
-#define SD_WRITE_SECTOR(Sector, Buffer) sd_write_sector((StartOfPartition+Sector), Buffer)
+#define SD_READ_SECTOR(Class, Sector, Buffer) do { STOP_READ_STREAM(); IO_STATS_COUNT(Reads, Class); sd_read_sector((StartOfPartition+Sector), Buffer); } while(0)
+#define SD_WRITE_SECTOR(Class, Sector, Buffer) do { STOP_READ_STREAM(); IO_STATS_COUNT(Writes, Class); sd_write_sector((StartOfPartition+Sector), Buffer); } while(0)
+#define SD_WRITE_MULTIPLE_START(Sector, NbPreErase) do { STOP_READ_STREAM(); sd_write_multiple_start((StartOfPartition+Sector), NbPreErase); } while(0)
+#define SD_READ_MULTIPLE_START(Sector) sd_read_multiple_start(StartOfPartition+Sector)
 #else
-#define SD_READ_SECTOR(Sector, Buffer) sd_read_sector(Sector, Buffer)
-#define SD_WRITE_SECTOR(Sector, Buffer) sd_write_sector(Sector, Buffer)
+#define SD_READ_SECTOR(Class, Sector, Buffer) do { STOP_READ_STREAM(); IO_STATS_COUNT(Reads, Class); sd_read_sector(Sector, Buffer); } while(0)
+#define SD_WRITE_SECTOR(Class, Sector, Buffer) do { STOP_READ_STREAM(); IO_STATS_COUNT(Writes, Class); sd_write_sector(Sector, Buffer); } while(0)
+#define SD_WRITE_MULTIPLE_START(Sector, NbPreErase) do { STOP_READ_STREAM(); sd_write_multiple_start(Sector, NbPreErase); } while(0)
+#define SD_READ_MULTIPLE_START(Sector) sd_read_multiple_start(Sector)
 #endif
+#define SD_WRITE_MULTIPLE_SECTOR(Buffer) do { IO_STATS_COUNT(Writes, FS32_IO_DATA); sd_write_multiple_sector(Buffer); } while(0)
+#define SD_READ_MULTIPLE_SECTOR(Buffer) do { IO_STATS_COUNT(Reads, FS32_IO_DATA); sd_read_multiple_sector(Buffer); } while(0)
 
 //You need to provide these functions:
 void sd_read_sector(const uint32_t sector, uint8_t * const data);
 void sd_write_sector(const uint32_t sector, uint8_t const * const data);
+#if FS32_MULTI_BLOCK_WRITE_SUPPORT
+void sd_write_multiple_start(const uint32_t sector, const uint32_t nb_sectors_pre_erase);
+void sd_write_multiple_sector(uint8_t const * const data);
+void sd_write_multiple_stop(void);
+#endif
+#if FS32_MULTI_BLOCK_READ_SUPPORT
+void sd_read_multiple_start(const uint32_t sector);
+void sd_read_multiple_sector(uint8_t * const data);
+void sd_read_multiple_stop(void);
+#endif
 uint16_t rtc_get_encoded_date(void);
 uint16_t rtc_get_encoded_time(void);
 
@@ -2,8 +2,10 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include <avr/pgmspace.h>
 #include <avr/interrupt.h>
+#include <avr/eeprom.h>
 
 #include "sw_uart_tx.h"
 
@@ -12,6 +14,9 @@
 #include "sd.h"
 
 #include "FS32.h"
+#include "FS32_config.h"
+
+#include "pdm_header.h"
 
 /*
 This file is part of mega328-pdm-audio (c) 2022 by kittennbfive.
@@ -23,10 +28,37 @@ Please read the fine manual!
 version 1 - 29.05.22
 */
 
-#define VALUE_UBBR 11 //ADJUST THIS! (see documentation)
+#define VALUE_UBBR 11 //ADJUST THIS if the file has no header! (see documentation)
+
+#define PCM_MODE 0 //set to 1 if PDM.BIN contains 8 bit PCM (pdmconv --pcm8), the AVR will do the modulation (see documentation)
+
+#define OSR 24 //only used with PCM_MODE, ADJUST THIS if the file has no header! must be a multiple of 4
 
+#define COMPRESSED 0 //set to 1 if the PDM.BIN was made with pdmconv --compress (see documentation)
 
+
+#if PCM_MODE
+#define SZ_BUFFER 256 //do not change unless you want to hack!
+#define SZ_PCM_BUFFER 256 //FS32 needs its own 512 bytes, RAM is tight
+#else
 #define SZ_BUFFER 512 //do not change unless you want to hack!
+#endif
+
+#if PCM_MODE && (OSR%4)
+#error OSR must be a multiple of 4 with PCM_MODE
+#endif
+
+#if PCM_MODE && COMPRESSED
+#error PCM_MODE and COMPRESSED cannot be used together
+#endif
+
+#if PCM_MODE
+#define CODEC_OF_FIRMWARE PDM_HEADER_CODEC_PCM8
+#elif COMPRESSED
+#define CODEC_OF_FIRMWARE PDM_HEADER_CODEC_HUFFMAN
+#else
+#define CODEC_OF_FIRMWARE PDM_HEADER_CODEC_NONE
+#endif
 
 void sd_handle_io_error(const sd_error_t err)
 {
@@ -42,10 +74,9 @@ void sd_handle_io_error(const sd_error_t err)
 #define DBG1 PC1
 #define DBG2 PC2
 
-static volatile uint8_t buffer1[SZ_BUFFER];
-static volatile uint8_t buffer2[SZ_BUFFER];
-static volatile uint8_t * buffer_ptr_out=buffer1;
-static volatile uint8_t * buffer_ptr_sd=buffer2;
+static volatile uint8_t buffers[2][SZ_BUFFER]; //one after the other for f_read_sectors()
+static volatile uint8_t * buffer_ptr_out=buffers[0];
+static volatile uint8_t * buffer_ptr_sd=buffers[1];
 
 static volatile uint16_t index_b1=0;
 static volatile uint16_t index_b2=0;
@@ -54,6 +85,274 @@ static volatile uint16_t * index_ptr_sd=&index_b2;
 
 static volatile bool fill_buffer=false;
 
+#if FS32_BOOT_CACHE_SUPPORT
+//filled by kittenFS32 at the first start with a card, after that f_init and f_open only need to read 2 sectors
+typedef struct
+{
+	FS32_volume_cache_t volume;
+	FS32_file_cache_t file; //PDM.BIN
+} boot_cache_t;
+
+static boot_cache_t EEMEM eeprom_boot_cache;
+#endif
+
+#if PCM_MODE
+static uint8_t bytes_per_sample=2*OSR/8; //from the header if there is one
+#endif
+
+//from the header, sectors of the data like there, loop_end==0 if the file doesn't loop
+static uint32_t loop_start=0;
+static uint32_t loop_end=0;
+
+//returns false if this is not a valid header, halts if the file can't be played by this firmware
+static bool parse_header(pdm_header_t const * const header, uint16_t * const ubbr)
+{
+	if(memcmp(header->magic, PDM_HEADER_MAGIC, 4) || header->version!=PDM_HEADER_VERSION || header->checksum!=pdm_header_checksum(header))
+		return false;
+
+	printf_P(PSTR("header: %uHz OSR %u codec %u\r\n"), header->sample_rate, header->osr, header->codec);
+
+	if(header->codec!=CODEC_OF_FIRMWARE)
+	{
+		printf_P(PSTR("this firmware can't play codec %u (see PCM_MODE and COMPRESSED)\r\n"), header->codec);
+		while(1);
+	}
+
+	if(header->nb_sectors==0)
+	{
+		printf_P(PSTR("no data\r\n"));
+		while(1);
+	}
+
+#if PCM_MODE
+	if(header->osr%4)
+	{
+		printf_P(PSTR("OSR must be a multiple of 4\r\n"));
+		while(1);
+	}
+	bytes_per_sample=2*header->osr/8;
+#endif
+
+	if(header->f_cpu==F_CPU)
+		(*ubbr)=header->ubbr;
+	else //file was made for another clock
+		(*ubbr)=(F_CPU/((uint32_t)header->sample_rate*header->osr)+2)/4-1;
+
+	if(header->loop_end)
+	{
+		printf_P(PSTR("loop: sectors %lu to %lu\r\n"), header->loop_start, header->loop_end);
+		loop_start=header->loop_start;
+		loop_end=header->loop_end;
+	}
+
+	return true;
+}
+
+#if PCM_MODE
+static uint8_t pcm_buffer[SZ_PCM_BUFFER];
+static uint16_t pcm_index=SZ_PCM_BUFFER;
+static int8_t pcm_sample;
+static uint8_t bytes_left_for_sample=0;
+
+static int16_t integrator1=0, integrator2=0;
+
+//normal audio keeps the integrators below about 1000 and 6000, but loud content close to half the sample rate overloads the modulator at low OSR and they would run away
+//clamped once per byte to these limits they can't overflow whatever the sample: in 8 bits integrator2 changes by at most 8*2048+28*255+8*128=24548
+#define PCM_INTEGRATOR1_LIMIT 2048
+#define PCM_INTEGRATOR2_LIMIT 8192
+
+//second-order modulator (AoE3 figure 13.55) for 8 bit input
+static uint8_t modulate_byte(const int8_t sample)
+{
+	uint8_t packed=0;
+	uint8_t bit;
+
+	if(integrator1>PCM_INTEGRATOR1_LIMIT)
+		integrator1=PCM_INTEGRATOR1_LIMIT;
+	else if(integrator1<-PCM_INTEGRATOR1_LIMIT)
+		integrator1=-PCM_INTEGRATOR1_LIMIT;
+	if(integrator2>PCM_INTEGRATOR2_LIMIT)
+		integrator2=PCM_INTEGRATOR2_LIMIT;
+	else if(integrator2<-PCM_INTEGRATOR2_LIMIT)
+		integrator2=-PCM_INTEGRATOR2_LIMIT;
+
+	for(bit=0; bit<8; bit++)
+	{
+		integrator2+=integrator1;
+		packed<<=1;
+		if(integrator2<0)
+		{
+			integrator1+=(int16_t)sample+128;
+			integrator2+=128;
+		}
+		else
+		{
+			packed|=1;
+			integrator1+=(int16_t)sample-127;
+			integrator2-=127;
+		}
+	}
+
+	return packed;
+}
+
+//returns false if there is no more data in the file
+static bool fill_buffer_pcm(volatile uint8_t * const buffer, const uint8_t filenr)
+{
+	uint16_t i;
+
+	for(i=0; i<SZ_BUFFER; i++)
+	{
+		if(bytes_left_for_sample==0)
+		{
+			if(pcm_index==SZ_PCM_BUFFER)
+			{
+				DEBUG|=(1<<DBG0);
+				FS32_status_t status=f_read(filenr, pcm_buffer, SZ_PCM_BUFFER, 1);
+				DEBUG&=~(1<<DBG0);
+				if(status)
+					return false;
+				pcm_index=0;
+			}
+			pcm_sample=(int8_t)pcm_buffer[pcm_index++];
+			bytes_left_for_sample=bytes_per_sample;
+		}
+		bytes_left_for_sample--;
+		buffer[i]=modulate_byte(pcm_sample);
+	}
+
+	return true;
+}
+#endif
+
+#if COMPRESSED
+#define PDM_CODEC_DECODER 1
+#include "pdm_codec.h"
+
+#define SZ_CODEC_CHUNK 32 //small reads from the same sector don't access the card again
+
+static uint8_t codec_chunk[SZ_CODEC_CHUNK];
+static uint8_t codec_chunk_index=SZ_CODEC_CHUNK;
+static uint8_t codec_file;
+static uint16_t codec_sector_index=0; //position in the current sector of the file
+
+static uint8_t codec_read_byte(void)
+{
+	if(codec_chunk_index==SZ_CODEC_CHUNK)
+	{
+		DEBUG|=(1<<DBG0);
+		FS32_status_t status=f_read(codec_file, codec_chunk, SZ_CODEC_CHUNK, 1);
+		DEBUG&=~(1<<DBG0);
+		if(status)
+			memset(codec_chunk, 0, SZ_CODEC_CHUNK); //reads as PDM_CODEC_END
+		codec_chunk_index=0;
+	}
+	codec_sector_index=(codec_sector_index+1)%512;
+	return codec_chunk[codec_chunk_index++];
+}
+
+static uint16_t codec_payload_left;
+
+static uint8_t codec_read_payload_byte(void)
+{
+	if(codec_payload_left==0)
+		return 0;
+	codec_payload_left--;
+	return codec_read_byte();
+}
+
+//returns false at the end of the data, needs at most PDM_CODEC_MAX_CODE_LENGTH-PDM_CODEC_LUT_BITS+1 table lookups per byte
+static bool codec_decode_block(volatile uint8_t * const buffer)
+{
+	uint16_t header=codec_read_byte();
+	header|=(uint16_t)codec_read_byte()<<8;
+
+	if(header==PDM_CODEC_END && loop_end)
+	{
+		//end of the part before the loop or of the loop, the next block starts at the next sector (FS32 goes back to the loop start at its end)
+		while(codec_sector_index)
+			codec_read_byte();
+		header=codec_read_byte();
+		header|=(uint16_t)codec_read_byte()<<8;
+	}
+
+	if(header==PDM_CODEC_END)
+		return false;
+
+	uint16_t i;
+
+	if(header==PDM_CODEC_STORED)
+	{
+		for(i=0; i<PDM_CODEC_BLOCK_SIZE; i++)
+			buffer[i]=codec_read_byte();
+		return true;
+	}
+
+	codec_payload_left=header;
+
+	uint16_t window=0; //next bits of the payload, MSB first
+	uint8_t nb_bits=0;
+	uint8_t previous=0;
+
+	for(i=0; i<PDM_CODEC_BLOCK_SIZE; i++)
+	{
+		while(nb_bits<=8)
+		{
+			window|=(uint16_t)codec_read_payload_byte()<<(8-nb_bits);
+			nb_bits+=8;
+		}
+
+		uint8_t table=pgm_read_byte(&pdm_codec_table_of_context[previous]);
+		uint8_t peek=window>>8;
+		uint8_t len=pgm_read_byte(&pdm_codec_lut_len[table][peek]);
+		uint8_t symbol=0;
+
+		if(len)
+		{
+			symbol=pgm_read_byte(&pdm_codec_lut_sym[table][peek]);
+			window<<=len;
+			nb_bits-=len;
+		}
+		else
+		{
+			//long code, continue bit by bit
+			uint16_t code=peek;
+			window<<=PDM_CODEC_LUT_BITS;
+			nb_bits-=PDM_CODEC_LUT_BITS;
+
+			uint8_t l;
+			for(l=0; l<PDM_CODEC_MAX_CODE_LENGTH-PDM_CODEC_LUT_BITS; l++)
+			{
+				if(nb_bits==0)
+				{
+					window=(uint16_t)codec_read_payload_byte()<<8;
+					nb_bits=8;
+				}
+				code=(code<<1)|(window>>15);
+				window<<=1;
+				nb_bits--;
+
+				uint16_t offset=code-pgm_read_word(&pdm_codec_long_first[table][l]);
+				if(offset<pgm_read_byte(&pdm_codec_long_count[table][l]))
+				{
+					symbol=pgm_read_byte(&pdm_codec_long_symbols[pgm_read_word(&pdm_codec_long_index[table][l])+offset]);
+					break;
+				}
+			}
+		}
+
+		buffer[i]=symbol;
+		previous=symbol;
+	}
+
+	//only for corrupted data
+	while(codec_payload_left)
+		codec_read_payload_byte();
+
+	return true;
+}
+#endif
+
 ISR(USART_UDRE_vect)
 {
 	UDR0=buffer_ptr_out[(*index_ptr_out)++];
@@ -80,7 +379,6 @@ int main(void)
 	UBRR0=0;
 	UCSR0B=(1<<TXEN0)|(1<<UDRIE0);
 	UCSR0C=(1<<UMSEL01)|(1<<UMSEL00);
-	UBRR0=VALUE_UBBR;
 
 	//software UART
 	sw_uart_tx_init();
@@ -102,7 +400,13 @@ int main(void)
 	}
 
 	FS32_status_t status;
+#if FS32_BOOT_CACHE_SUPPORT
+	boot_cache_t boot_cache;
+	eeprom_read_block(&boot_cache, &eeprom_boot_cache, sizeof(boot_cache_t));
+	status=f_init_cached(&boot_cache.volume);
+#else
 	status=f_init();
+#endif
 	if(status)
 	{
 		printf_P(PSTR("f_init failed: %u\r\n"), (uint8_t)status);
@@ -110,26 +414,104 @@ int main(void)
 	}
 
 	uint8_t dummy;
+#if FS32_BOOT_CACHE_SUPPORT
+	status=f_open_cached(&dummy, "PDM.BIN", &boot_cache.file);
+#else
 	status=f_open(&dummy, "PDM.BIN", 'r');
+#endif
 	if(status)
 	{
 		printf_P(PSTR("f_open failed: %u\r\n"), (uint8_t)status);
 		while(1);
 	}
 
-	status=f_read(dummy, (uint8_t*)buffer1, SZ_BUFFER, 1);
+#if FS32_BOOT_CACHE_SUPPORT
+	eeprom_update_block(&boot_cache, &eeprom_boot_cache, sizeof(boot_cache_t)); //only writes bytes that changed, so nothing for the same card
+#endif
+
+	uint16_t ubbr=VALUE_UBBR;
+	pdm_header_t header;
+	status=f_read(dummy, &header, sizeof(pdm_header_t), 1);
+	if(!status && parse_header(&header, &ubbr))
+	{
+		//skip the rest of the header sector
+		uint16_t left=512-sizeof(pdm_header_t);
+		while(left)
+		{
+			uint16_t nb=(left>SZ_BUFFER)?SZ_BUFFER:left;
+			f_read(dummy, (uint8_t*)buffers[0], nb, 1);
+			left-=nb;
+		}
+	}
+	else
+	{
+		//no header, start again at the beginning of the file
+		printf_P(PSTR("no header, using settings from the code\r\n"));
+		f_close(dummy);
+#if FS32_BOOT_CACHE_SUPPORT
+		status=f_open_cached(&dummy, "PDM.BIN", &boot_cache.file);
+#else
+		status=f_open(&dummy, "PDM.BIN", 'r');
+#endif
+		if(status)
+		{
+			printf_P(PSTR("f_open failed: %u\r\n"), (uint8_t)status);
+			while(1);
+		}
+	}
+	UBRR0=ubbr;
+
+	if(loop_end)
+	{
+#if FS32_LOOP_SUPPORT
+		//the refill below just keeps reading, FS32 continues at the loop start at the end of the loop
+		status=f_loop(dummy, (1+loop_start)*512, (1+loop_end)*512);
+		if(status)
+		{
+			printf_P(PSTR("f_loop failed: %u\r\n"), (uint8_t)status);
+			while(1);
+		}
+#else
+		printf_P(PSTR("FS32_LOOP_SUPPORT is 0, playing the loop once\r\n"));
+#endif
+	}
+
+#if PCM_MODE
+	if(!fill_buffer_pcm(buffers[0], dummy) || !fill_buffer_pcm(buffers[1], dummy))
+	{
+		printf_P(PSTR("initial PCM read failed\r\n"));
+		while(1);
+	}
+#elif COMPRESSED
+	codec_file=dummy;
+	if(!codec_decode_block(buffers[0]) || !codec_decode_block(buffers[1]))
+	{
+		printf_P(PSTR("initial decoding failed\r\n"));
+		while(1);
+	}
+#elif FS32_MULTI_BLOCK_READ_SUPPORT
+	//the two buffers are a ring of 2 sectors, filled directly from the card by a multi-block read that stays open
+	status=f_read_sectors(dummy, (uint8_t*)buffers, 2, 0, 2);
+	if(status)
+	{
+		printf_P(PSTR("initial f_read_sectors failed: %u\r\n"), (uint8_t)status);
+		while(1);
+	}
+#else
+	status=f_read(dummy, (uint8_t*)buffers[0], SZ_BUFFER, 1);
 	if(status)
 	{
 		printf_P(PSTR("initial f_read buffer1 failed: %u\r\n"), (uint8_t)status);
 		while(1);
 	}
 
-	status=f_read(dummy, (uint8_t*)buffer2, SZ_BUFFER, 1);
+	status=f_read(dummy, (uint8_t*)buffers[1], SZ_BUFFER, 1);
 	if(status)
 	{
 		printf_P(PSTR("initial f_read buffer2 failed: %u\r\n"), (uint8_t)status);
 		while(1);
 	}
+#endif
 
 	printf_P(PSTR("starting playback\r\n"));
 
@@ -137,12 +519,45 @@ int main(void)
 	
 	while(1)
 	{
+#if PCM_MODE
+		if(fill_buffer)
+		{
+			fill_buffer=false;
+			(*index_ptr_sd)=0;
+			DEBUG|=(1<<DBG1);
+			bool more_data=fill_buffer_pcm(buffer_ptr_sd, dummy);
+			DEBUG&=~(1<<DBG1);
+			if(!more_data)
+			{
+				cli();
+				break;
+			}
+		}
+#elif COMPRESSED
+		if(fill_buffer)
+		{
+			fill_buffer=false;
+			(*index_ptr_sd)=0;
+			DEBUG|=(1<<DBG1);
+			bool more_data=codec_decode_block(buffer_ptr_sd);
+			DEBUG&=~(1<<DBG1);
+			if(!more_data)
+			{
+				cli();
+				break;
+			}
+		}
+#else
 		if(fill_buffer)
 		{
 			fill_buffer=false;
 			(*index_ptr_sd)=0;
 			DEBUG|=(1<<DBG0);
+#if FS32_MULTI_BLOCK_READ_SUPPORT
+			status=f_read_sectors(dummy, (uint8_t*)buffers, 2, (buffer_ptr_sd==buffers[0])?0:1, 1);
+#else
 			status=f_read(dummy, (uint8_t*)buffer_ptr_sd, SZ_BUFFER, 1);
+#endif
 			DEBUG&=~(1<<DBG0);
 			if(status)
 			{
@@ -150,10 +565,17 @@ int main(void)
 				break;
 			}
 		}
+#endif
 	}
 
 	f_close(dummy);
 
+#if FS32_IO_STATS
+	FS32_stats_t stats;
+	f_stats(&stats);
+	printf_P(PSTR("sectors read boot/FSInfo/FAT/dir/data: %lu %lu %lu %lu %lu\r\n"), stats.Reads[FS32_IO_BOOT], stats.Reads[FS32_IO_FSINFO], stats.Reads[FS32_IO_FAT], stats.Reads[FS32_IO_DIR], stats.Reads[FS32_IO_DATA]);
+#endif
+
 	printf_P(PSTR("finished, going into endless loop\r\n"));
 
 	while(1);
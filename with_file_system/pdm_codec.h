@@ -0,0 +1,1218 @@
+#ifndef __PDM_CODEC_H__
+#define __PDM_CODEC_H__
+#include <stdint.h>
+
+/*
+This file is part of mega328-pdm-audio (c) 2022 by kittennbfive.
+
+AGPLv3+ and NO WARRANTY!
+
+GENERATED BY pdmtables FROM 992000 BYTES OF SAMPLE DATA - DO NOT EDIT!
+All copies of this file (pdmconv and both firmwares) must be identical.
+
+Format of a compressed file: a stream of blocks, each decoding to PDM_CODEC_BLOCK_SIZE bytes of PDM-data. A block starts with a little endian uint16_t:
+- PDM_CODEC_END: end of data, the rest of the file is padding
+- PDM_CODEC_STORED: PDM_CODEC_BLOCK_SIZE bytes of uncompressed data follow
+- else the number of bytes of Huffman-coded data that follow
+
+Huffman-coded data is read MSB first. The table for a byte is pdm_codec_table_of_context[previous byte of the block] (0 for the first byte).
+A decoder looks at the next PDM_CODEC_LUT_BITS bits: if pdm_codec_lut_len!=0 the symbol is complete, else it appends single bits until for length l the code minus pdm_codec_long_first is smaller than pdm_codec_long_count.
+*/
+
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+
+#define PDM_CODEC_BLOCK_SIZE 512
+#define PDM_CODEC_END 0x0000
+#define PDM_CODEC_STORED 0x8000
+#define PDM_CODEC_NB_TABLES 16
+#define PDM_CODEC_MAX_CODE_LENGTH 12
+#define PDM_CODEC_LUT_BITS 8
+
+static const uint8_t pdm_codec_table_of_context[256] PROGMEM=
+{
+		3,14,14,14,14,14,14,14,14,14,14,14,8,11,13,0,
+		14,14,14,14,8,11,13,13,8,11,4,13,1,0,9,0,
+		14,14,14,14,8,14,11,11,8,8,3,13,12,0,9,9,
+		8,8,1,13,12,0,9,9,12,2,10,9,15,9,15,15,
+		14,14,14,14,14,14,11,11,8,8,8,11,1,13,0,13,
+		8,8,8,11,12,0,2,9,12,6,10,9,15,9,15,15,
+		8,8,8,11,12,7,2,13,12,3,5,9,10,9,15,15,
+		12,1,10,9,10,9,15,15,10,15,15,15,15,15,15,15,
+		14,14,14,14,14,14,14,11,14,14,8,11,8,11,0,13,
+		14,14,8,11,8,7,2,13,12,3,5,13,10,9,9,9,
+		14,14,8,14,8,11,4,13,8,3,1,13,10,9,9,9,
+		12,1,12,0,10,9,9,9,10,10,15,15,15,15,15,15,
+		14,14,8,14,8,11,3,13,8,8,1,13,12,0,9,9,
+		8,8,1,13,12,2,9,9,10,10,15,9,15,15,15,15,
+		0,8,1,0,12,6,10,9,0,12,10,9,15,15,15,15,
+		0,10,10,9,10,15,15,15,15,15,15,15,15,15,15,15
+};
+
+#if PDM_CODEC_ENCODER
+//code length of each symbol, the encoder builds the canonical codes from this
+static const uint8_t pdm_codec_length[PDM_CODEC_NB_TABLES][256]=
+{
+	{
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,7,12,6,12,12,12,
+		12,12,6,5,5,4,12,12,5,6,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,7,5,6,12,
+		12,12,12,5,6,2,4,12,7,5,6,12,12,12,12,12,
+		12,12,12,6,12,5,5,7,12,12,7,8,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,6,12,
+		12,12,12,12,12,5,6,12,12,6,5,7,6,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,7,6,10,7,12,12,
+		12,12,12,8,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12
+	},
+	{
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,7,12,12,12,
+		12,12,7,10,6,7,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,6,7,5,6,12,12,6,5,12,12,12,12,12,
+		12,6,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,7,6,12,12,7,5,5,12,6,12,12,12,
+		12,12,12,12,12,6,5,7,12,4,2,6,5,12,12,12,
+		12,6,5,7,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,6,6,12,12,4,5,5,6,12,12,
+		12,12,12,6,12,7,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12
+	},
+	{
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,8,10,7,6,12,12,7,6,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,6,12,12,
+		12,12,12,6,7,4,4,12,12,3,7,12,12,12,12,12,
+		12,12,12,12,12,4,3,8,12,5,5,6,7,12,12,12,
+		12,12,7,7,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,5,5,12,6,12,12,12,
+		12,12,12,12,12,12,12,8,12,12,5,5,5,5,12,12,
+		12,12,12,5,12,6,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,8,12,6,6,12,
+		12,12,12,12,12,7,7,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12
+	},
+	{
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,7,7,12,12,12,12,12,
+		12,6,6,12,8,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,6,12,5,12,12,12,
+		12,12,5,5,5,5,12,12,8,12,12,12,12,12,12,12,
+		12,12,9,6,8,5,5,12,12,8,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,7,7,12,12,
+		12,12,12,7,6,5,5,12,7,3,4,12,12,12,12,12,
+		12,12,12,12,12,7,3,12,12,4,4,7,7,12,12,12,
+		12,12,7,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,6,7,12,12,6,7,8,8,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12
+	},
+	{
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,7,6,12,12,12,12,12,
+		12,7,5,7,6,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,6,7,12,12,
+		12,12,12,5,5,5,12,12,7,6,12,12,12,12,12,12,
+		12,12,12,6,12,5,4,12,12,4,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,6,6,12,12,4,3,12,12,12,12,12,
+		12,12,12,12,12,12,3,8,12,4,3,7,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12
+	},
+	{
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,7,12,12,12,8,12,12,12,12,12,12,
+		12,12,12,12,12,6,4,12,12,3,3,12,12,12,12,12,
+		12,7,7,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,7,3,12,7,12,12,12,
+		12,12,12,12,12,12,4,7,12,5,4,5,5,7,12,12,
+		12,12,6,5,12,5,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,6,7,5,6,12,
+		12,12,12,12,12,5,6,12,12,6,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12
+	},
+	{
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,7,9,3,4,12,8,3,12,12,12,12,12,12,
+		12,12,12,12,12,3,4,12,12,6,6,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,4,12,12,4,5,12,6,12,12,12,
+		12,12,12,12,12,12,6,7,12,12,5,5,5,12,12,12,
+		12,12,7,6,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,6,7,5,7,12,
+		12,12,12,12,12,6,7,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12
+	},
+	{
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,8,7,12,12,12,12,12,12,
+		12,12,12,12,12,12,6,12,12,5,5,12,12,12,12,12,
+		12,5,5,7,6,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,5,12,5,6,12,12,
+		12,12,6,5,5,4,5,12,7,4,12,12,12,12,12,12,
+		12,12,12,6,12,3,7,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,7,7,12,
+		12,12,12,12,12,4,3,12,12,4,6,12,12,12,12,12,
+		12,12,12,12,12,12,7,12,12,12,7,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12
+	},
+	{
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,7,12,7,12,12,12,7,12,12,12,12,12,12,12,
+		12,12,7,12,5,7,12,12,5,6,10,12,12,12,12,12,
+		6,6,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,7,6,6,12,6,5,5,12,6,12,12,12,
+		7,5,4,8,6,12,12,12,12,12,12,12,12,12,12,12,
+		12,6,6,7,7,8,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,7,12,12,6,5,12,5,12,12,12,
+		12,7,4,6,4,6,12,12,5,7,12,12,12,12,12,12,
+		12,8,6,6,5,5,6,12,7,6,8,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,8,7,7,6,6,12,12,7,7,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12
+	},
+	{
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,7,7,12,12,6,6,7,7,8,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,8,6,7,12,6,5,5,6,6,8,12,
+		12,12,12,12,12,12,7,5,12,12,6,4,6,4,7,12,
+		12,12,12,5,12,5,6,12,12,7,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,8,7,7,6,6,12,
+		12,12,12,12,12,12,12,12,12,12,12,6,8,4,5,7,
+		12,12,12,6,12,5,5,6,12,6,6,7,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,6,6,
+		12,12,12,12,12,10,6,5,12,12,7,5,12,7,12,12,
+		12,12,12,12,12,12,12,7,12,12,12,7,12,7,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12
+	},
+	{
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,11,12,12,8,5,12,12,12,12,12,
+		12,6,5,6,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,8,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,4,5,4,5,12,12,
+		12,12,6,4,7,4,6,12,12,6,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,7,5,4,12,
+		12,12,12,7,12,4,4,7,12,5,5,8,12,12,12,12,
+		12,12,12,12,12,6,4,5,12,12,6,5,8,12,12,12,
+		12,12,12,7,12,12,12,12,12,12,12,12,12,12,12,12
+	},
+	{
+		12,12,12,12,12,12,12,12,12,12,12,12,7,12,12,12,
+		12,12,12,8,5,6,12,12,5,5,6,12,12,12,12,12,
+		12,12,12,12,8,5,4,12,7,4,4,12,7,12,12,12,
+		12,4,5,7,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,6,12,12,6,4,7,4,6,12,12,
+		12,12,5,4,5,4,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,8,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,6,5,6,12,
+		12,12,12,12,8,5,11,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12
+	},
+	{
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,11,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,8,8,7,7,12,12,12,7,12,12,12,12,12,12,
+		12,8,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,7,7,12,12,12,12,12,12,
+		12,12,12,12,8,6,6,12,12,5,4,7,5,12,12,12,
+		12,7,4,5,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,8,6,12,12,6,4,4,3,5,12,12,
+		12,12,6,3,5,4,8,12,12,12,12,12,12,12,12,12,
+		12,12,12,5,12,5,7,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12
+	},
+	{
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,7,5,12,5,12,12,12,
+		12,12,12,12,12,12,12,12,12,8,4,5,3,6,12,12,
+		12,12,5,3,4,4,6,12,12,6,8,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,5,4,7,12,
+		12,12,12,5,7,4,5,12,12,6,6,8,12,12,12,12,
+		12,12,12,12,12,8,7,7,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,7,12,12,8,7,7,8,11,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12
+	},
+	{
+		12,12,7,12,6,7,7,12,6,6,6,12,6,12,12,12,
+		6,5,4,12,4,11,12,12,5,12,12,12,12,12,12,12,
+		6,5,5,7,4,5,8,12,5,6,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		7,6,5,8,5,6,7,12,5,6,7,12,12,12,12,12,
+		7,7,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,7,6,12,5,6,7,12,5,5,6,12,8,12,12,12,
+		6,6,6,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		7,7,7,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12
+	},
+	{
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,7,7,7,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,6,6,6,
+		12,12,12,8,12,6,6,5,12,7,6,5,12,6,7,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,7,7,
+		12,12,12,12,12,7,6,5,12,7,6,5,8,5,6,7,
+		12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,12,
+		12,12,12,12,12,12,6,5,12,8,5,4,7,5,5,6,
+		12,12,12,12,12,12,12,5,12,12,11,4,12,4,5,6,
+		12,12,12,6,12,5,6,6,12,7,7,6,12,7,12,12
+	}
+};
+#endif
+
+#if PDM_CODEC_DECODER
+static const uint8_t pdm_codec_lut_len[PDM_CODEC_NB_TABLES][1<<PDM_CODEC_LUT_BITS] PROGMEM=
+{
+	{
+		2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+		2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+		2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+		2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,
+		8,8,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+		2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+		2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+		2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,
+		7,7,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,7,7,7,7,
+		7,7,7,7,7,7,7,7,7,7,7,7,7,7,8,8,
+		8,8,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,7,7,7,7,7,7,7,7,7,7,7,7,
+		7,7,7,7,7,7,7,7,7,7,7,7,8,8,8,8,
+		8,8,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,7,7,7,7,7,7,7,7,7,7,7,7,
+		8,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,
+		8,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,7,7,7,7,7,7,7,7,7,7,7,7,
+		8,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,
+		8,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,7,7,7,7,
+		7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,
+		7,7,7,7,7,7,7,7,7,7,7,7,7,7,8,8,
+		8,8,8,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,7,7,7,7,
+		7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,
+		7,7,7,7,7,7,7,7,7,7,7,7,7,7,8,8,
+		8,8,8,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,7,7,7,7,7,7,7,7,7,7,8,8,
+		8,8,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,7,7,7,7,7,7,7,7,7,7,8,8,
+		8,8,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,7,7,7,7,
+		7,7,7,7,7,7,7,7,7,7,7,7,8,8,8,8,
+		8,8,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,7,7,7,7,
+		7,7,7,7,7,7,7,7,7,7,7,7,8,8,8,8,
+		8,8,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,7,7,7,7,7,7,7,7,7,7,7,7,
+		7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,
+		8,8,8,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+		6,6,6,6,7,7,7,7,7,7,7,7,7,7,7,7,
+		7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,
+		8,8,8,0,0,0,0,0,0,0,0,0,0,0,0,0
+	}
+};
+
+static const uint8_t pdm_codec_lut_sym[PDM_CODEC_NB_TABLES][1<<PDM_CODEC_LUT_BITS] PROGMEM=
+{
+	{
+		85,85,85,85,85,85,85,85,85,85,85,85,85,85,85,85,
+		85,85,85,85,85,85,85,85,85,85,85,85,85,85,85,85,
+		85,85,85,85,85,85,85,85,85,85,85,85,85,85,85,85,
+		85,85,85,85,85,85,85,85,85,85,85,85,85,85,85,85,
+		53,53,53,53,53,53,53,53,53,53,53,53,53,53,53,53,
+		86,86,86,86,86,86,86,86,86,86,86,86,86,86,86,86,
+		51,51,51,51,51,51,51,51,52,52,52,52,52,52,52,52,
+		56,56,56,56,56,56,56,56,77,77,77,77,77,77,77,77,
+		83,83,83,83,83,83,83,83,89,89,89,89,89,89,89,89,
+		101,101,101,101,101,101,101,101,102,102,102,102,102,102,102,102,
+		149,149,149,149,149,149,149,149,154,154,154,154,154,154,154,154,
+		44,44,44,44,50,50,50,50,57,57,57,57,78,78,78,78,
+		84,84,84,84,90,90,90,90,99,99,99,99,142,142,142,142,
+		150,150,150,150,153,153,153,153,156,156,156,156,171,171,171,171,
+		42,42,76,76,88,88,103,103,106,106,155,155,170,170,173,173,
+		107,179,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,
+		170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,
+		170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,
+		170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,
+		169,169,169,169,169,169,169,169,169,169,169,169,169,169,169,169,
+		202,202,202,202,202,202,202,202,202,202,202,202,202,202,202,202,
+		101,101,101,101,101,101,101,101,106,106,106,106,106,106,106,106,
+		153,153,153,153,153,153,153,153,154,154,154,154,154,154,154,154,
+		166,166,166,166,166,166,166,166,172,172,172,172,172,172,172,172,
+		178,178,178,178,178,178,178,178,203,203,203,203,203,203,203,203,
+		204,204,204,204,204,204,204,204,84,84,84,84,99,99,99,99,
+		102,102,102,102,105,105,105,105,113,113,113,113,149,149,149,149,
+		156,156,156,156,165,165,165,165,171,171,171,171,177,177,177,177,
+		198,198,198,198,199,199,199,199,205,205,205,205,211,211,211,211,
+		76,76,82,82,85,85,100,100,148,148,152,152,167,167,179,179,
+		213,213,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,
+		89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,
+		102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,
+		102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,
+		85,85,85,85,85,85,85,85,85,85,85,85,85,85,85,85,
+		86,86,86,86,86,86,86,86,86,86,86,86,86,86,86,86,
+		101,101,101,101,101,101,101,101,101,101,101,101,101,101,101,101,
+		105,105,105,105,105,105,105,105,106,106,106,106,106,106,106,106,
+		153,153,153,153,153,153,153,153,154,154,154,154,154,154,154,154,
+		170,170,170,170,170,170,170,170,171,171,171,171,171,171,171,171,
+		172,172,172,172,172,172,172,172,173,173,173,173,173,173,173,173,
+		179,179,179,179,179,179,179,179,53,53,53,53,57,57,57,57,
+		77,77,77,77,83,83,83,83,107,107,107,107,156,156,156,156,
+		181,181,181,181,205,205,205,205,206,206,206,206,52,52,56,56,
+		84,84,90,90,108,108,114,114,115,115,213,213,214,214,50,103,
+		167,203,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,
+		153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,
+		166,166,166,166,166,166,166,166,166,166,166,166,166,166,166,166,
+		166,166,166,166,166,166,166,166,166,166,166,166,166,166,166,166,
+		154,154,154,154,154,154,154,154,154,154,154,154,154,154,154,154,
+		169,169,169,169,169,169,169,169,169,169,169,169,169,169,169,169,
+		170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,
+		76,76,76,76,76,76,76,76,82,82,82,82,82,82,82,82,
+		83,83,83,83,83,83,83,83,84,84,84,84,84,84,84,84,
+		85,85,85,85,85,85,85,85,101,101,101,101,101,101,101,101,
+		102,102,102,102,102,102,102,102,149,149,149,149,149,149,149,149,
+		150,150,150,150,150,150,150,150,49,49,49,49,50,50,50,50,
+		74,74,74,74,99,99,99,99,148,148,148,148,198,198,198,198,
+		202,202,202,202,41,41,42,42,140,140,141,141,147,147,152,152,
+		165,165,171,171,172,172,178,178,199,199,203,203,52,88,100,105,
+		204,205,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		154,154,154,154,154,154,154,154,154,154,154,154,154,154,154,154,
+		154,154,154,154,154,154,154,154,154,154,154,154,154,154,154,154,
+		166,166,166,166,166,166,166,166,166,166,166,166,166,166,166,166,
+		166,166,166,166,166,166,166,166,166,166,166,166,166,166,166,166,
+		170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,
+		170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,
+		102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,
+		105,105,105,105,105,105,105,105,105,105,105,105,105,105,105,105,
+		153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,
+		169,169,169,169,169,169,169,169,169,169,169,169,169,169,169,169,
+		50,50,50,50,50,50,50,50,83,83,83,83,83,83,83,83,
+		84,84,84,84,84,84,84,84,85,85,85,85,85,85,85,85,
+		101,101,101,101,101,101,101,101,42,42,42,42,52,52,52,52,
+		76,76,76,76,89,89,89,89,99,99,99,99,149,149,149,149,
+		150,150,150,150,41,41,49,49,51,51,77,77,88,88,171,171,
+		167,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		105,105,105,105,105,105,105,105,105,105,105,105,105,105,105,105,
+		105,105,105,105,105,105,105,105,105,105,105,105,105,105,105,105,
+		106,106,106,106,106,106,106,106,106,106,106,106,106,106,106,106,
+		106,106,106,106,106,106,106,106,106,106,106,106,106,106,106,106,
+		154,154,154,154,154,154,154,154,154,154,154,154,154,154,154,154,
+		154,154,154,154,154,154,154,154,154,154,154,154,154,154,154,154,
+		102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,
+		166,166,166,166,166,166,166,166,166,166,166,166,166,166,166,166,
+		170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,
+		169,169,169,169,169,169,169,169,171,171,171,171,171,171,171,171,
+		172,172,172,172,172,172,172,172,179,179,179,179,179,179,179,179,
+		181,181,181,181,181,181,181,181,205,205,205,205,205,205,205,205,
+		213,213,213,213,213,213,213,213,101,101,101,101,178,178,178,178,
+		203,203,203,203,206,206,206,206,214,214,214,214,217,217,217,217,
+		85,85,113,113,114,114,153,153,156,156,167,167,173,173,204,204,
+		89,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		85,85,85,85,85,85,85,85,85,85,85,85,85,85,85,85,
+		85,85,85,85,85,85,85,85,85,85,85,85,85,85,85,85,
+		89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,
+		89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,
+		101,101,101,101,101,101,101,101,101,101,101,101,101,101,101,101,
+		101,101,101,101,101,101,101,101,101,101,101,101,101,101,101,101,
+		86,86,86,86,86,86,86,86,86,86,86,86,86,86,86,86,
+		102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,102,
+		150,150,150,150,150,150,150,150,150,150,150,150,150,150,150,150,
+		153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,
+		154,154,154,154,154,154,154,154,170,170,170,170,170,170,170,170,
+		171,171,171,171,171,171,171,171,172,172,172,172,172,172,172,172,
+		205,205,205,205,205,205,205,205,105,105,105,105,106,106,106,106,
+		156,156,156,156,166,166,166,166,179,179,179,179,203,203,203,203,
+		213,213,213,213,83,83,167,167,178,178,204,204,206,206,214,214,
+		88,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		101,101,101,101,101,101,101,101,101,101,101,101,101,101,101,101,
+		101,101,101,101,101,101,101,101,101,101,101,101,101,101,101,101,
+		150,150,150,150,150,150,150,150,150,150,150,150,150,150,150,150,
+		150,150,150,150,150,150,150,150,150,150,150,150,150,150,150,150,
+		85,85,85,85,85,85,85,85,85,85,85,85,85,85,85,85,
+		89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,89,
+		149,149,149,149,149,149,149,149,149,149,149,149,149,149,149,149,
+		153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,153,
+		41,41,41,41,41,41,41,41,42,42,42,42,42,42,42,42,
+		49,49,49,49,49,49,49,49,50,50,50,50,50,50,50,50,
+		74,74,74,74,74,74,74,74,76,76,76,76,76,76,76,76,
+		83,83,83,83,83,83,83,83,84,84,84,84,84,84,84,84,
+		86,86,86,86,86,86,86,86,38,38,38,38,52,52,52,52,
+		77,77,77,77,82,82,82,82,99,99,99,99,154,154,154,154,
+		25,25,51,51,88,88,102,102,141,141,142,142,166,166,170,170,
+		24,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		82,82,82,82,82,82,82,82,82,82,82,82,82,82,82,82,
+		146,146,146,146,146,146,146,146,146,146,146,146,146,146,146,146,
+		148,148,148,148,148,148,148,148,148,148,148,148,148,148,148,148,
+		36,36,36,36,36,36,36,36,40,40,40,40,40,40,40,40,
+		73,73,73,73,73,73,73,73,74,74,74,74,74,74,74,74,
+		81,81,81,81,81,81,81,81,138,138,138,138,138,138,138,138,
+		140,140,140,140,140,140,140,140,152,152,152,152,152,152,152,152,
+		164,164,164,164,164,164,164,164,165,165,165,165,165,165,165,165,
+		41,41,41,41,48,48,48,48,49,49,49,49,69,69,69,69,
+		70,70,70,70,72,72,72,72,76,76,76,76,84,84,84,84,
+		97,97,97,97,98,98,98,98,137,137,137,137,147,147,147,147,
+		149,149,149,149,162,162,162,162,163,163,163,163,166,166,166,166,
+		169,169,169,169,197,197,197,197,198,198,198,198,18,18,20,20,
+		24,24,34,34,37,37,68,68,80,80,99,99,100,100,134,134,
+		145,145,153,153,168,168,195,195,196,196,201,201,202,202,83,101,
+		161,170,194,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,107,
+		109,109,109,109,109,109,109,109,109,109,109,109,109,109,109,109,
+		173,173,173,173,173,173,173,173,173,173,173,173,173,173,173,173,
+		90,90,90,90,90,90,90,90,91,91,91,91,91,91,91,91,
+		103,103,103,103,103,103,103,103,115,115,115,115,115,115,115,115,
+		117,117,117,117,117,117,117,117,174,174,174,174,174,174,174,174,
+		181,181,181,181,181,181,181,181,182,182,182,182,182,182,182,182,
+		215,215,215,215,215,215,215,215,219,219,219,219,219,219,219,219,
+		57,57,57,57,58,58,58,58,86,86,86,86,89,89,89,89,
+		92,92,92,92,93,93,93,93,106,106,106,106,108,108,108,108,
+		118,118,118,118,157,157,157,157,158,158,158,158,171,171,171,171,
+		179,179,179,179,183,183,183,183,185,185,185,185,186,186,186,186,
+		206,206,206,206,207,207,207,207,214,214,214,214,53,53,54,54,
+		59,59,60,60,87,87,102,102,110,110,121,121,155,155,156,156,
+		175,175,187,187,218,218,221,221,231,231,235,235,237,237,61,85,
+		94,154,172,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,
+		172,172,172,172,172,172,172,172,172,172,172,172,172,172,172,172,
+		179,179,179,179,179,179,179,179,179,179,179,179,179,179,179,179,
+		181,181,181,181,181,181,181,181,181,181,181,181,181,181,181,181,
+		206,206,206,206,206,206,206,206,206,206,206,206,206,206,206,206,
+		213,213,213,213,213,213,213,213,213,213,213,213,213,213,213,213,
+		214,214,214,214,214,214,214,214,214,214,214,214,214,214,214,214,
+		230,230,230,230,230,230,230,230,230,230,230,230,230,230,230,230,
+		106,106,106,106,106,106,106,106,114,114,114,114,114,114,114,114,
+		171,171,171,171,171,171,171,171,173,173,173,173,173,173,173,173,
+		205,205,205,205,205,205,205,205,217,217,217,217,217,217,217,217,
+		218,218,218,218,218,218,218,218,231,231,231,231,231,231,231,231,
+		235,235,235,235,235,235,235,235,113,113,113,113,115,115,115,115,
+		178,178,178,178,182,182,182,182,185,185,185,185,229,229,229,229,
+		234,234,234,234,180,180,204,204,211,211,215,215,243,243,105,156,
+		219,236,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		38,38,38,38,38,38,38,38,38,38,38,38,38,38,38,38,
+		41,41,41,41,41,41,41,41,41,41,41,41,41,41,41,41,
+		42,42,42,42,42,42,42,42,42,42,42,42,42,42,42,42,
+		49,49,49,49,49,49,49,49,49,49,49,49,49,49,49,49,
+		74,74,74,74,74,74,74,74,74,74,74,74,74,74,74,74,
+		76,76,76,76,76,76,76,76,76,76,76,76,76,76,76,76,
+		83,83,83,83,83,83,83,83,83,83,83,83,83,83,83,83,
+		85,85,85,85,85,85,85,85,85,85,85,85,85,85,85,85,
+		20,20,20,20,20,20,20,20,24,24,24,24,24,24,24,24,
+		25,25,25,25,25,25,25,25,37,37,37,37,37,37,37,37,
+		50,50,50,50,50,50,50,50,82,82,82,82,82,82,82,82,
+		84,84,84,84,84,84,84,84,141,141,141,141,141,141,141,141,
+		149,149,149,149,149,149,149,149,21,21,21,21,26,26,26,26,
+		70,70,70,70,73,73,73,73,77,77,77,77,140,140,140,140,
+		142,142,142,142,12,12,40,40,44,44,51,51,75,75,19,36,
+		99,148,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,
+		204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,204,
+		211,211,211,211,211,211,211,211,211,211,211,211,211,211,211,211,
+		211,211,211,211,211,211,211,211,211,211,211,211,211,211,211,211,
+		170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,170,
+		178,178,178,178,178,178,178,178,178,178,178,178,178,178,178,178,
+		202,202,202,202,202,202,202,202,202,202,202,202,202,202,202,202,
+		203,203,203,203,203,203,203,203,203,203,203,203,203,203,203,203,
+		213,213,213,213,213,213,213,213,213,213,213,213,213,213,213,213,
+		169,169,169,169,169,169,169,169,172,172,172,172,172,172,172,172,
+		179,179,179,179,179,179,179,179,205,205,205,205,205,205,205,205,
+		212,212,212,212,212,212,212,212,227,227,227,227,227,227,227,227,
+		229,229,229,229,229,229,229,229,165,165,165,165,166,166,166,166,
+		198,198,198,198,201,201,201,201,210,210,210,210,100,100,101,101,
+		105,105,152,152,153,153,171,171,177,177,230,230,98,99,113,164,
+		197,214,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		44,44,44,44,44,44,44,44,44,44,44,44,44,44,44,44,
+		44,44,44,44,44,44,44,44,44,44,44,44,44,44,44,44,
+		51,51,51,51,51,51,51,51,51,51,51,51,51,51,51,51,
+		51,51,51,51,51,51,51,51,51,51,51,51,51,51,51,51,
+		42,42,42,42,42,42,42,42,42,42,42,42,42,42,42,42,
+		52,52,52,52,52,52,52,52,52,52,52,52,52,52,52,52,
+		53,53,53,53,53,53,53,53,53,53,53,53,53,53,53,53,
+		77,77,77,77,77,77,77,77,77,77,77,77,77,77,77,77,
+		85,85,85,85,85,85,85,85,85,85,85,85,85,85,85,85,
+		26,26,26,26,26,26,26,26,28,28,28,28,28,28,28,28,
+		43,43,43,43,43,43,43,43,50,50,50,50,50,50,50,50,
+		76,76,76,76,76,76,76,76,83,83,83,83,83,83,83,83,
+		86,86,86,86,86,86,86,86,45,45,45,45,54,54,54,54,
+		57,57,57,57,89,89,89,89,90,90,90,90,25,25,78,78,
+		84,84,102,102,103,103,150,150,154,154,155,155,41,58,91,101,
+		153,156,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		18,18,18,18,18,18,18,18,18,18,18,18,18,18,18,18,
+		20,20,20,20,20,20,20,20,20,20,20,20,20,20,20,20,
+		36,36,36,36,36,36,36,36,36,36,36,36,36,36,36,36,
+		17,17,17,17,17,17,17,17,24,24,24,24,24,24,24,24,
+		33,33,33,33,33,33,33,33,34,34,34,34,34,34,34,34,
+		37,37,37,37,37,37,37,37,40,40,40,40,40,40,40,40,
+		66,66,66,66,66,66,66,66,68,68,68,68,68,68,68,68,
+		72,72,72,72,72,72,72,72,132,132,132,132,132,132,132,132,
+		136,136,136,136,136,136,136,136,137,137,137,137,137,137,137,137,
+		4,4,4,4,8,8,8,8,9,9,9,9,10,10,10,10,
+		12,12,12,12,16,16,16,16,32,32,32,32,41,41,41,41,
+		65,65,65,65,69,69,69,69,73,73,73,73,130,130,130,130,
+		133,133,133,133,138,138,138,138,144,144,144,144,145,145,145,145,
+		146,146,146,146,2,2,5,5,6,6,35,35,64,64,70,70,
+		74,74,80,80,81,81,129,129,134,134,160,160,161,161,162,162,
+		38,67,140,0,0,0,0,0,0,0,0,0,0,0,0,0
+	},
+	{
+		219,219,219,219,219,219,219,219,219,219,219,219,219,219,219,219,
+		235,235,235,235,235,235,235,235,235,235,235,235,235,235,235,235,
+		237,237,237,237,237,237,237,237,237,237,237,237,237,237,237,237,
+		119,119,119,119,119,119,119,119,123,123,123,123,123,123,123,123,
+		183,183,183,183,183,183,183,183,187,187,187,187,187,187,187,187,
+		189,189,189,189,189,189,189,189,215,215,215,215,215,215,215,215,
+		218,218,218,218,218,218,218,218,221,221,221,221,221,221,221,221,
+		222,222,222,222,222,222,222,222,231,231,231,231,231,231,231,231,
+		238,238,238,238,238,238,238,238,245,245,245,245,245,245,245,245,
+		109,109,109,109,110,110,110,110,111,111,111,111,117,117,117,117,
+		118,118,118,118,122,122,122,122,125,125,125,125,182,182,182,182,
+		186,186,186,186,190,190,190,190,214,214,214,214,223,223,223,223,
+		239,239,239,239,243,243,243,243,246,246,246,246,247,247,247,247,
+		251,251,251,251,93,93,94,94,95,95,121,121,126,126,174,174,
+		175,175,181,181,185,185,191,191,220,220,249,249,250,250,253,253,
+		115,188,217,0,0,0,0,0,0,0,0,0,0,0,0,0
+	}
+};
+
+//[table][length-PDM_CODEC_LUT_BITS-1]
+static const uint16_t pdm_codec_long_first[PDM_CODEC_NB_TABLES][PDM_CODEC_MAX_CODE_LENGTH-PDM_CODEC_LUT_BITS] PROGMEM=
+{
+	{ 0, 968, 0, 3876 },
+	{ 0, 968, 0, 3876 },
+	{ 0, 968, 0, 3876 },
+	{ 484, 0, 0, 3880 },
+	{ 0, 0, 0, 3856 },
+	{ 0, 0, 0, 3856 },
+	{ 482, 0, 0, 3864 },
+	{ 0, 0, 0, 3856 },
+	{ 0, 972, 0, 3892 },
+	{ 0, 972, 0, 3892 },
+	{ 0, 0, 1936, 3874 },
+	{ 0, 0, 1936, 3874 },
+	{ 0, 0, 1936, 3874 },
+	{ 0, 0, 1936, 3874 },
+	{ 0, 0, 1944, 3890 },
+	{ 0, 0, 1944, 3890 }
+};
+
+static const uint16_t pdm_codec_long_index[PDM_CODEC_NB_TABLES][PDM_CODEC_MAX_CODE_LENGTH-PDM_CODEC_LUT_BITS] PROGMEM=
+{
+	{ 0, 0, 0, 1 },
+	{ 0, 221, 0, 222 },
+	{ 0, 442, 0, 443 },
+	{ 662, 0, 0, 663 },
+	{ 0, 0, 0, 879 },
+	{ 0, 0, 0, 1109 },
+	{ 1337, 0, 0, 1338 },
+	{ 0, 0, 0, 1567 },
+	{ 0, 1793, 0, 1794 },
+	{ 0, 1995, 0, 1996 },
+	{ 0, 0, 2197, 2198 },
+	{ 0, 0, 2420, 2421 },
+	{ 0, 0, 2643, 2644 },
+	{ 0, 0, 2866, 2867 },
+	{ 0, 0, 3089, 3090 },
+	{ 0, 0, 3296, 3297 }
+};
+
+static const uint8_t pdm_codec_long_count[PDM_CODEC_NB_TABLES][PDM_CODEC_MAX_CODE_LENGTH-PDM_CODEC_LUT_BITS] PROGMEM=
+{
+	{ 0, 1, 0, 220 },
+	{ 0, 1, 0, 220 },
+	{ 0, 1, 0, 219 },
+	{ 1, 0, 0, 216 },
+	{ 0, 0, 0, 230 },
+	{ 0, 0, 0, 228 },
+	{ 1, 0, 0, 229 },
+	{ 0, 0, 0, 226 },
+	{ 0, 1, 0, 201 },
+	{ 0, 1, 0, 201 },
+	{ 0, 0, 1, 222 },
+	{ 0, 0, 1, 222 },
+	{ 0, 0, 1, 222 },
+	{ 0, 0, 1, 222 },
+	{ 0, 0, 1, 206 },
+	{ 0, 0, 1, 206 }
+};
+
+static const uint8_t pdm_codec_long_symbols[3503] PROGMEM=
+{
+		172,0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,
+		15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30,
+		31,32,33,34,35,36,37,38,39,40,41,43,45,46,47,48,
+		49,54,55,58,59,60,61,62,63,64,65,66,67,68,69,70,
+		71,72,73,74,75,79,80,81,82,87,91,92,93,94,95,96,
+		97,98,100,104,105,108,109,110,111,112,113,114,115,116,117,118,
+		119,120,121,122,123,124,125,126,127,128,129,130,131,132,133,134,
+		135,136,137,138,139,140,141,143,144,145,146,147,148,151,152,157,
+		158,159,160,161,162,163,164,165,166,167,168,169,174,175,176,177,
+		178,180,181,182,183,184,185,186,187,188,189,190,191,192,193,194,
+		195,196,197,198,199,200,201,202,203,204,205,206,207,208,209,210,
+		211,212,213,214,215,216,217,218,219,220,221,222,223,224,225,226,
+		227,228,229,230,231,232,233,234,235,236,237,238,239,240,241,242,
+		243,244,245,246,247,248,249,250,251,252,253,254,255,83,0,1,
+		2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,
+		18,19,20,21,22,23,24,25,26,27,28,29,30,31,32,33,
+		34,35,36,37,38,39,40,41,42,43,44,45,46,47,48,49,
+		50,51,52,53,54,55,56,57,58,59,60,61,62,63,64,65,
+		66,67,68,69,70,71,72,73,74,75,77,78,79,80,81,86,
+		87,88,89,90,91,92,93,94,95,96,97,98,103,104,107,108,
+		109,110,111,112,114,115,116,117,118,119,120,121,122,123,124,125,
+		126,127,128,129,130,131,132,133,134,135,136,137,138,139,140,141,
+		142,143,144,145,146,147,150,151,155,157,158,159,160,161,162,163,
+		164,168,173,174,175,176,180,181,182,183,184,185,186,187,188,189,
+		190,191,192,193,194,195,196,197,200,201,206,207,208,209,210,212,
+		214,215,216,217,218,219,220,221,222,223,224,225,226,227,228,229,
+		230,231,232,233,234,235,236,237,238,239,240,241,242,243,244,245,
+		246,247,248,249,250,251,252,253,254,255,51,0,1,2,3,4,
+		5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,
+		21,22,23,24,25,26,27,28,29,30,31,32,33,34,35,36,
+		37,38,39,40,41,42,43,44,45,46,47,48,49,54,55,58,
+		59,60,61,62,63,64,65,66,67,68,69,70,71,72,73,74,
+		75,76,78,79,80,81,82,87,88,91,92,93,94,95,96,97,
+		98,99,100,104,109,110,111,112,113,116,117,118,119,120,121,122,
+		123,124,125,126,127,128,129,130,131,132,133,134,135,136,137,138,
+		139,140,141,142,143,144,145,146,147,148,149,150,151,152,155,157,
+		158,159,160,161,162,163,164,165,166,168,169,174,175,176,177,178,
+		180,182,183,184,185,186,187,188,189,190,191,192,193,194,195,196,
+		197,198,199,200,201,202,204,207,208,209,210,211,212,215,216,217,
+		218,219,220,221,222,223,224,225,226,227,228,229,230,231,232,233,
+		234,235,236,237,238,239,240,241,242,243,244,245,246,247,248,249,
+		250,251,252,253,254,255,98,0,1,2,3,4,5,6,7,8,
+		9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,
+		25,26,27,28,29,30,31,32,33,34,35,36,37,38,39,40,
+		43,44,45,46,47,48,51,53,54,55,56,57,58,59,60,61,
+		62,63,64,65,66,67,68,69,70,71,72,73,75,77,78,79,
+		80,81,86,87,89,90,91,92,93,94,95,96,97,103,104,106,
+		107,108,109,110,111,112,113,114,115,116,117,118,119,120,121,122,
+		123,124,125,126,127,128,129,130,131,132,133,134,135,136,137,138,
+		139,142,143,144,145,146,151,155,156,157,158,159,160,161,162,163,
+		164,167,168,173,174,175,176,177,179,180,181,182,183,184,185,186,
+		187,188,189,190,191,192,193,194,195,196,197,200,201,206,207,208,
+		209,210,211,212,213,214,215,216,217,218,219,220,221,222,223,224,
+		225,226,227,228,229,230,231,232,233,234,235,236,237,238,239,240,
+		241,242,243,244,245,246,247,248,249,250,251,252,253,254,255,0,
+		1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,
+		17,18,19,20,21,22,23,24,25,26,27,28,29,30,31,32,
+		33,34,35,36,37,38,39,40,43,44,45,46,47,48,53,54,
+		55,56,57,58,59,60,61,62,63,64,65,66,67,68,69,70,
+		71,72,73,74,75,78,79,80,81,82,86,87,90,91,92,93,
+		94,95,96,97,98,100,103,104,106,107,108,109,110,111,112,113,
+		114,115,116,117,118,119,120,121,122,123,124,125,126,127,128,129,
+		130,131,132,133,134,135,136,137,138,139,140,141,142,143,144,145,
+		146,147,148,151,152,155,156,157,158,159,160,161,162,163,164,165,
+		168,172,173,174,175,176,177,178,179,180,181,182,183,184,185,186,
+		187,188,189,190,191,192,193,194,195,196,197,198,199,200,201,202,
+		203,204,205,206,207,208,209,210,211,212,213,214,215,216,217,218,
+		219,220,221,222,223,224,225,226,227,228,229,230,231,232,233,234,
+		235,236,237,238,239,240,241,242,243,244,245,246,247,248,249,250,
+		251,252,253,254,255,0,1,2,3,4,5,6,7,8,9,10,
+		11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,
+		27,28,29,30,31,32,33,34,35,36,37,38,39,40,41,42,
+		43,44,45,46,47,48,49,50,51,52,53,54,55,56,57,58,
+		59,60,61,62,63,64,65,66,67,68,69,70,71,72,73,74,
+		75,76,77,78,79,80,81,82,83,84,86,87,88,90,91,92,
+		93,94,95,96,97,98,99,100,103,104,107,108,109,110,111,112,
+		115,116,117,118,119,120,121,122,123,124,125,126,127,128,129,130,
+		131,132,133,134,135,136,137,138,139,140,141,142,143,144,145,146,
+		147,148,149,150,151,152,155,157,158,159,160,161,162,163,164,165,
+		168,174,175,176,177,180,182,183,184,185,186,187,188,189,190,191,
+		192,193,194,195,196,197,198,199,200,201,202,207,208,209,210,211,
+		212,215,216,218,219,220,221,222,223,224,225,226,227,228,229,230,
+		231,232,233,234,235,236,237,238,239,240,241,242,243,244,245,246,
+		247,248,249,250,251,252,253,254,255,84,0,1,2,3,4,5,
+		6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,
+		22,23,24,25,26,27,28,29,30,31,32,33,34,35,36,37,
+		38,39,40,41,42,43,44,45,46,47,48,49,50,51,52,53,
+		54,55,56,57,58,59,60,61,62,63,64,65,66,67,68,69,
+		70,71,72,73,74,75,76,77,78,79,80,81,82,87,90,91,
+		92,93,94,95,96,97,98,99,100,103,104,107,108,109,110,111,
+		112,113,114,115,116,117,118,119,120,121,122,123,124,125,126,127,
+		128,129,130,131,132,133,134,135,136,137,138,139,140,141,142,143,
+		144,145,146,147,148,149,151,152,155,157,158,159,160,161,162,163,
+		164,165,168,169,173,174,175,176,177,180,181,182,183,184,185,186,
+		187,188,189,190,191,192,193,194,195,196,197,198,199,200,201,202,
+		207,208,209,210,211,212,215,216,217,218,219,220,221,222,223,224,
+		225,226,227,228,229,230,231,232,233,234,235,236,237,238,239,240,
+		241,242,243,244,245,246,247,248,249,250,251,252,253,254,255,0,
+		1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,
+		17,18,19,20,21,22,23,26,27,28,29,30,31,32,33,34,
+		35,36,37,39,40,43,44,45,46,47,48,53,54,55,56,57,
+		58,59,60,61,62,63,64,65,66,67,68,69,70,71,72,73,
+		75,78,79,80,81,87,90,91,92,93,94,95,96,97,98,100,
+		103,104,105,106,107,108,109,110,111,112,113,114,115,116,117,118,
+		119,120,121,122,123,124,125,126,127,128,129,130,131,132,133,134,
+		135,136,137,138,139,140,143,144,145,146,147,148,151,152,155,156,
+		157,158,159,160,161,162,163,164,165,167,168,169,171,172,173,174,
+		175,176,177,178,179,180,181,182,183,184,185,186,187,188,189,190,
+		191,192,193,194,195,196,197,198,199,200,201,202,203,204,205,206,
+		207,208,209,210,211,212,213,214,215,216,217,218,219,220,221,222,
+		223,224,225,226,227,228,229,230,231,232,233,234,235,236,237,238,
+		239,240,241,242,243,244,245,246,247,248,249,250,251,252,253,254,
+		255,42,0,1,2,3,4,5,6,7,8,9,10,11,12,13,
+		14,15,16,17,19,21,22,23,25,26,27,28,29,30,31,32,
+		33,35,38,39,43,44,45,46,47,50,51,52,53,54,55,56,
+		57,58,59,60,61,62,63,64,65,66,67,71,75,77,78,79,
+		85,86,87,88,89,90,91,92,93,94,95,96,102,103,104,105,
+		106,107,108,109,110,111,112,113,114,115,116,117,118,119,120,121,
+		122,123,124,125,126,127,128,129,130,131,132,133,135,136,139,141,
+		142,143,144,150,151,154,155,156,157,158,159,160,167,171,172,173,
+		174,175,176,177,178,179,180,181,182,183,184,185,186,187,188,189,
+		190,191,192,193,199,200,203,204,205,206,207,208,209,210,211,212,
+		213,214,215,216,217,218,219,220,221,222,223,224,225,226,227,228,
+		229,230,231,232,233,234,235,236,237,238,239,240,241,242,243,244,
+		245,246,247,248,249,250,251,252,253,254,255,213,0,1,2,3,
+		4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,
+		20,21,22,23,24,25,26,27,28,29,30,31,32,33,34,35,
+		36,37,38,39,40,41,42,43,44,45,46,47,48,49,50,51,
+		52,55,56,62,63,64,65,66,67,68,69,70,71,72,73,74,
+		75,76,77,78,79,80,81,82,83,84,88,95,96,97,98,99,
+		100,101,104,105,111,112,113,114,116,119,120,122,123,124,125,126,
+		127,128,129,130,131,132,133,134,135,136,137,138,139,140,141,142,
+		143,144,145,146,147,148,149,150,151,152,153,159,160,161,162,163,
+		164,165,166,167,168,169,170,176,177,178,180,184,188,189,190,191,
+		192,193,194,195,196,197,198,199,200,201,202,203,204,205,208,209,
+		210,211,212,216,217,220,222,223,224,225,226,227,228,229,230,232,
+		233,234,236,238,239,240,241,242,243,244,245,246,247,248,249,250,
+		251,252,253,254,255,102,0,1,2,3,4,5,6,7,8,9,
+		10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,
+		26,27,28,29,30,31,32,33,34,35,36,37,38,39,40,41,
+		42,43,44,45,46,47,48,49,50,51,52,53,54,55,56,57,
+		58,59,60,61,62,63,64,65,66,67,68,69,70,71,72,73,
+		74,75,76,77,78,79,80,81,82,83,84,85,86,87,88,89,
+		90,91,92,93,94,95,96,97,98,99,100,101,103,104,107,108,
+		109,110,111,112,116,117,118,119,120,121,122,123,124,125,126,127,
+		128,129,130,131,132,133,134,135,136,137,138,139,140,141,142,143,
+		144,145,146,147,148,149,150,151,152,153,154,155,157,158,159,160,
+		161,162,163,164,165,166,167,168,169,174,175,176,177,183,184,186,
+		187,188,189,190,191,192,193,194,195,196,197,198,199,200,201,202,
+		203,207,208,209,210,212,216,220,221,222,223,224,225,226,227,228,
+		232,233,237,238,239,240,241,242,244,245,246,247,248,249,250,251,
+		252,253,254,255,150,0,1,2,3,4,5,6,7,8,9,10,
+		11,13,14,15,16,17,18,22,23,27,28,29,30,31,32,33,
+		34,35,39,43,45,46,47,48,52,53,54,55,56,57,58,59,
+		60,61,62,63,64,65,66,67,68,69,71,72,78,79,80,81,
+		86,87,88,89,90,91,92,93,94,95,96,97,98,100,101,102,
+		103,104,105,106,107,108,109,110,111,112,113,114,115,116,117,118,
+		119,120,121,122,123,124,125,126,127,128,129,130,131,132,133,134,
+		135,136,137,138,139,143,144,145,146,147,151,152,153,154,155,156,
+		157,158,159,160,161,162,163,164,165,166,167,168,169,170,171,172,
+		173,174,175,176,177,178,179,180,181,182,183,184,185,186,187,188,
+		189,190,191,192,193,194,195,196,197,198,199,200,201,202,203,204,
+		205,206,207,208,209,210,211,212,213,214,215,216,217,218,219,220,
+		221,222,223,224,225,226,227,228,229,230,231,232,233,234,235,236,
+		237,238,239,240,241,242,243,244,245,246,247,248,249,250,251,252,
+		253,254,255,84,0,1,2,3,4,5,6,7,8,9,10,11,
+		12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,
+		28,29,30,31,32,33,34,35,36,37,38,39,40,41,42,43,
+		44,45,46,47,48,49,50,51,52,53,54,55,56,57,58,59,
+		60,61,62,63,64,65,66,67,68,69,70,71,72,73,74,75,
+		76,77,78,79,80,81,82,83,85,86,87,88,89,90,91,92,
+		93,94,95,96,97,102,103,104,106,107,108,109,110,111,112,114,
+		115,116,117,118,119,120,121,122,123,124,125,126,127,128,129,130,
+		131,132,133,134,135,136,137,138,139,140,141,142,143,144,145,146,
+		147,148,149,150,151,154,155,156,157,158,159,160,161,162,163,167,
+		168,173,174,175,176,180,181,182,183,184,185,186,187,188,189,190,
+		191,192,193,194,195,196,199,200,206,207,208,209,215,216,217,218,
+		219,220,221,222,223,224,225,226,228,231,232,233,234,235,236,237,
+		238,239,240,241,242,243,244,245,246,247,248,249,250,251,252,253,
+		254,255,157,0,1,2,3,4,5,6,7,8,9,10,11,12,
+		13,14,15,16,17,18,19,20,21,22,23,24,27,29,30,31,
+		32,33,34,35,36,37,38,39,40,46,47,48,49,55,56,59,
+		60,61,62,63,64,65,66,67,68,69,70,71,72,73,74,75,
+		79,80,81,82,87,88,92,93,94,95,96,97,98,99,100,104,
+		105,106,107,108,109,110,111,112,113,114,115,116,117,118,119,120,
+		121,122,123,124,125,126,127,128,129,130,131,132,133,134,135,136,
+		137,138,139,140,141,142,143,144,145,146,147,148,149,151,152,158,
+		159,160,161,162,163,164,165,166,167,168,169,170,171,172,173,174,
+		175,176,177,178,179,180,181,182,183,184,185,186,187,188,189,190,
+		191,192,193,194,195,196,197,198,199,200,201,202,203,204,205,206,
+		207,208,209,210,211,212,213,214,215,216,217,218,219,220,221,222,
+		223,224,225,226,227,228,229,230,231,232,233,234,235,236,237,238,
+		239,240,241,242,243,244,245,246,247,248,249,250,251,252,253,254,
+		255,21,0,1,3,7,11,13,14,15,19,22,23,25,26,27,
+		28,29,30,31,39,42,43,44,45,46,47,48,49,50,51,52,
+		53,54,55,56,57,58,59,60,61,62,63,71,75,76,77,78,
+		79,82,83,84,85,86,87,88,89,90,91,92,93,94,95,96,
+		97,98,99,100,101,102,103,104,105,106,107,108,109,110,111,112,
+		113,114,115,116,117,118,119,120,121,122,123,124,125,126,127,128,
+		131,135,139,141,142,143,147,148,149,150,151,152,153,154,155,156,
+		157,158,159,163,164,165,166,167,168,169,170,171,172,173,174,175,
+		176,177,178,179,180,181,182,183,184,185,186,187,188,189,190,191,
+		192,193,194,195,196,197,198,199,200,201,202,203,204,205,206,207,
+		208,209,210,211,212,213,214,215,216,217,218,219,220,221,222,223,
+		224,225,226,227,228,229,230,231,232,233,234,235,236,237,238,239,
+		240,241,242,243,244,245,246,247,248,249,250,251,252,253,254,255,
+		234,0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,
+		15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30,
+		31,32,33,34,35,36,37,38,39,40,41,42,43,44,45,46,
+		47,48,49,50,51,52,53,54,55,56,57,58,59,60,61,62,
+		63,64,65,66,67,68,69,70,71,72,73,74,75,76,77,78,
+		79,80,81,82,83,84,85,86,87,88,89,90,91,92,96,97,
+		98,99,100,101,102,103,104,105,106,107,108,112,113,114,116,120,
+		124,127,128,129,130,131,132,133,134,135,136,137,138,139,140,141,
+		142,143,144,145,146,147,148,149,150,151,152,153,154,155,156,157,
+		158,159,160,161,162,163,164,165,166,167,168,169,170,171,172,173,
+		176,177,178,179,180,184,192,193,194,195,196,197,198,199,200,201,
+		202,203,204,205,206,207,208,209,210,211,212,213,216,224,225,226,
+		227,228,229,230,232,233,236,240,241,242,244,248,252,254,255
+};
+#endif
+
+#endif
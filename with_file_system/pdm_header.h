@@ -0,0 +1,56 @@
+#ifndef __PDM_HEADER_H__
+#define __PDM_HEADER_H__
+#include <stdint.h>
+
+/*
+This file is part of mega328-pdm-audio (c) 2022 by kittennbfive.
+
+AGPLv3+ and NO WARRANTY!
+
+Please read the fine manual!
+
+Header in the first sector of a file made by pdmconv, the data starts at the second sector. The rest of the sector is 0.
+All copies of this file (pdmconv and both firmwares) must be identical.
+*/
+
+#define PDM_HEADER_MAGIC "kPDM"
+#define PDM_HEADER_VERSION 2 //2 added the loop
+
+#define PDM_HEADER_CODEC_NONE 0 //packed PDM-data
+#define PDM_HEADER_CODEC_HUFFMAN 1 //pdmconv --compress, see pdm_codec.h
+#define PDM_HEADER_CODEC_PCM8 2 //pdmconv --pcm8, modulation is done by the AVR
+
+typedef struct __attribute__((__packed__))
+{
+	char magic[4]; //PDM_HEADER_MAGIC, no terminating 0
+	uint8_t version; //PDM_HEADER_VERSION
+	uint8_t codec; //PDM_HEADER_CODEC_xxx
+	uint8_t osr;
+	uint8_t reserved; //0
+	uint16_t sample_rate; //Hz
+	uint16_t ubbr; //for f_cpu
+	uint32_t f_cpu; //Hz
+	uint32_t nb_bytes; //of PDM-data after decoding (number of samples for PCM8)
+	uint32_t nb_sectors; //of data following this header
+	uint32_t loop_start; //first sector of the loop, counted like nb_sectors (0 is the sector after the header)
+	uint32_t loop_end; //sector after the loop, playback continues at loop_start from there, 0 if the file doesn't loop
+	uint16_t checksum; //pdm_header_checksum() over all previous bytes
+} pdm_header_t;
+
+//Fletcher-16
+static inline uint16_t pdm_header_checksum(pdm_header_t const * const header)
+{
+	uint8_t const * data=(uint8_t const *)header;
+	uint16_t sum1=0, sum2=0;
+	uint8_t i;
+
+	for(i=0; i<sizeof(pdm_header_t)-sizeof(uint16_t); i++)
+	{
+		sum1=(sum1+data[i])%255;
+		sum2=(sum2+sum1)%255;
+	}
+
+	return (sum2<<8)|sum1;
+}
+
+#endif
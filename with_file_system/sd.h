@@ -35,7 +35,11 @@ typedef enum
 	
 	SD_READ_ERROR_CMD17,
 	SD_READ_ERROR_START_TOKEN,
+	SD_READ_ERROR_CMD18,
+	SD_READ_ERROR_CMD12,
 	SD_WRITE_ERROR_CMD24,
+	SD_WRITE_ERROR_ACMD23,
+	SD_WRITE_ERROR_CMD25,
 	SD_WRITE_INVALID_DATA_RESPONSE,
 	SD_WRITE_CRC_ERROR,
 	SD_WRITE_WRITE_ERROR,
@@ -46,4 +50,14 @@ sd_init_result_t sd_init(void);
 void sd_read_sector(const uint32_t sector, uint8_t * const data);
 void sd_write_sector(const uint32_t sector, uint8_t const * const data);
 
+//multi-block read: start, receive any number of sectors, stop. No other access to the card is allowed in between!
+void sd_read_multiple_start(const uint32_t sector);
+void sd_read_multiple_sector(uint8_t * const data);
+void sd_read_multiple_stop(void);
+
+//multi-block write: start, send any number of sectors, stop. No other access to the card is allowed in between!
+void sd_write_multiple_start(const uint32_t sector, const uint32_t nb_sectors_pre_erase);
+void sd_write_multiple_sector(uint8_t const * const data);
+void sd_write_multiple_stop(void);
+
 #endif